@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Process-wide heap allocation counter for the benchmarks. Counts calls to
+// malloc/calloc/realloc (where Qt's containers allocate) and operator new.
+namespace AllocCounter {
+    std::uint64_t count();
+}
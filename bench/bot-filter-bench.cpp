@@ -0,0 +1,199 @@
+// Bot filter cost with a large rule list: the compiled BotFilter versus
+// checking every rule in turn. Chatters come from a traffic file with one
+// IRC line per line; the rules are generated.
+//
+//   bot-filter-bench [traffic.irc] [rules] [passes]
+
+#include "bot-filter.hpp"
+#include "chat-event.hpp"
+#include "irc-message.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Chatter {
+    QString line;  // Backing storage for message; moving a QString keeps its buffer
+    IrcMessageView message;
+    ChatEvent event;  // Over message; filled once the vector stops moving
+    QString login;
+    QString displayName;
+};
+
+// Mostly names and wildcards, as real lists are, with a tail of regex,
+// badge and tag rules
+static QStringList generateRules(int count)
+{
+    QStringList rules;
+    rules.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        switch (i % 100) {
+            case 0:
+                rules.append(QStringLiteral("/^promo%1[0-9]+$/").arg(i));
+                break;
+            case 1:
+                rules.append(QStringLiteral("badge:sponsor%1").arg(i));
+                break;
+            case 2:
+                rules.append(QStringLiteral("tag:client-nonce=spam%1*").arg(i));
+                break;
+            default:
+                if (i % 5 == 0) {
+                    rules.append(QStringLiteral("*followers%1*").arg(i));
+                } else if (i % 5 == 1) {
+                    rules.append(QStringLiteral("viewbot%1_??").arg(i));
+                } else {
+                    rules.append(QStringLiteral("knownbot%1").arg(i));
+                }
+                break;
+        }
+    }
+    rules.append(QStringLiteral("nightbot"));
+    rules.append(QStringLiteral("*_bot"));
+    return rules;
+}
+
+// One check per rule, the way a plain list filter works
+class NaiveFilter {
+public:
+    explicit NaiveFilter(const QStringList &rules)
+    {
+        for (const QString &rule : rules) {
+            if (rule.startsWith(QStringLiteral("badge:"))) {
+                m_badges.append(rule.mid(6));
+            } else if (rule.startsWith(QStringLiteral("tag:"))) {
+                const qsizetype eqIndex = rule.indexOf('=');
+                m_tags.append({rule.mid(4, eqIndex - 4), rule.mid(eqIndex + 1)});
+            } else if (rule.startsWith('/')) {
+                m_regexes.emplace_back(rule.mid(1, rule.size() - 2), QRegularExpression::CaseInsensitiveOption);
+            } else if (rule.contains('*') || rule.contains('?')) {
+                m_globs.append(BotFilter::skeleton(rule));
+            } else {
+                m_names.append(BotFilter::skeleton(rule));
+            }
+        }
+    }
+
+    bool matches(const Chatter &chatter) const
+    {
+        const QString login = BotFilter::skeleton(chatter.login);
+        const QString display = BotFilter::skeleton(chatter.displayName);
+        for (const QString &name : m_names) {
+            if (name == login || name == display) {
+                return true;
+            }
+        }
+        for (const QString &glob : m_globs) {
+            if (BotFilter::globMatch(glob, login) || BotFilter::globMatch(glob, display)) {
+                return true;
+            }
+        }
+        for (const QRegularExpression &regex : m_regexes) {
+            if (regex.match(chatter.login).hasMatch() || regex.match(chatter.displayName).hasMatch()) {
+                return true;
+            }
+        }
+        const QStringView badges = chatter.message.tag(u"badges");
+        for (const QString &badge : m_badges) {
+            if (badges.contains(badge + QLatin1Char('/'))) {
+                return true;
+            }
+        }
+        for (const auto &tag : m_tags) {
+            const QStringView value = chatter.message.tag(tag.first);
+            if (!value.isNull() && BotFilter::globMatch(tag.second, value)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    QStringList m_names;
+    QStringList m_globs;
+    std::vector<QRegularExpression> m_regexes;
+    QStringList m_badges;
+    QList<QPair<QString, QString>> m_tags;
+};
+
+template<typename MatchFn>
+static void run(const char *name, const std::vector<Chatter> &chatters, int passes, MatchFn matches)
+{
+    qint64 matched = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const Chatter &chatter : chatters) {
+            matched += matches(chatter) ? 1 : 0;
+        }
+    }
+    const qint64 nanoseconds = timer.nsecsElapsed();
+    const qint64 lookups = qint64(chatters.size()) * passes;
+    std::printf("%-9s %14.1f %14.0f %10lld\n",
+                name,
+                double(nanoseconds) / double(lookups),
+                lookups / (nanoseconds / 1e9),
+                static_cast<long long>(matched / passes));
+}
+
+int main(int argc, char **argv)
+{
+    QString path = argc > 1 ? QString::fromLocal8Bit(argv[1])
+                            : QStringLiteral(FTC_BENCH_DATA_DIR "/twitch-raid-sample.irc");
+    int ruleCount = argc > 2 ? std::atoi(argv[2]) : 10000;
+    int passes = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s\n", qPrintable(path));
+        return 1;
+    }
+
+    // Every PRIVMSG counts as a first sighting; the filter runs once per chatter
+    std::vector<Chatter> chatters;
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    chatters.reserve(lines.size());
+    for (const QString &line : lines) {
+        Chatter chatter;
+        chatter.line = line;
+        if (!chatter.message.parse(chatter.line) || chatter.message.command != QStringView(u"PRIVMSG") ||
+            chatter.message.nick().isEmpty()) {
+            continue;
+        }
+        chatter.login = chatter.message.nick().toString().toLower();
+        chatter.displayName = chatter.message.tagValue(u"display-name");
+        chatters.push_back(std::move(chatter));
+    }
+    for (Chatter &chatter : chatters) {
+        chatter.event.parse(ChatEvent::Kind::Message, chatter.message);
+    }
+
+    const QStringList rules = generateRules(ruleCount);
+
+    QElapsedTimer compileTimer;
+    compileTimer.start();
+    QStringList errors;
+    std::shared_ptr<const BotFilter> filter = BotFilter::compile(rules, &errors);
+    const qint64 compileNs = compileTimer.nsecsElapsed();
+
+    compileTimer.restart();
+    NaiveFilter naive(rules);
+    const qint64 naiveSetupNs = compileTimer.nsecsElapsed();
+
+    std::printf("%lld chatters, %d rules (%lld rejected), %d passes\n",
+                static_cast<long long>(chatters.size()), filter->ruleCount(),
+                static_cast<long long>(errors.size()), passes);
+    std::printf("compile %.2f ms, naive setup %.2f ms\n\n", compileNs / 1e6, naiveSetupNs / 1e6);
+    std::printf("%-9s %14s %14s %10s\n", "filter", "ns/lookup", "lookups/sec", "matched");
+
+    run("naive", chatters, passes, [&naive](const Chatter &chatter) {
+        return naive.matches(chatter);
+    });
+    run("compiled", chatters, passes, [&filter](const Chatter &chatter) {
+        return filter->matches(chatter.login, chatter.displayName, chatter.event);
+    });
+    return 0;
+}
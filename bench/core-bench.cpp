@@ -0,0 +1,243 @@
+// The plugin's data structures on their own, with no network, event loop
+// or GUI: per-session dedup, the lifetime index, the greeted journal and the
+// session store, name interning and the chatter list's name search.
+// Small enough to run under perf or valgrind (callgrind, massif) as is.
+//
+//   core-bench [chatters] [messages]
+
+#include "chatter-key.hpp"
+#include "chatter-list-model.hpp"
+#include "chatter-registry.hpp"
+#include "chatter-tracker.hpp"
+#include "greeted-journal.hpp"
+#include "lifetime-index.hpp"
+#include "session-store.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void report(const char *name, qint64 elapsedNs, quint64 operations, quint64 hits)
+{
+    std::printf("%-22s %12.1f %14.0f %12llu\n", name,
+                operations ? double(elapsedNs) / operations : 0.0,
+                elapsedNs ? operations * 1e9 / elapsedNs : 0.0,
+                static_cast<unsigned long long>(hits));
+}
+
+int main(int argc, char **argv)
+{
+    // GreetedJournal owns a QTimer, which wants an application instance
+    QCoreApplication app(argc, argv);
+
+    const int chatterCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int messageCount = argc > 2 ? std::atoi(argv[2]) : 2000000;
+    if (chatterCount <= 0 || messageCount <= 0) {
+        std::fprintf(stderr, "usage: core-bench [chatters] [messages]\n");
+        return 1;
+    }
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "Cannot create a scratch directory\n");
+        return 1;
+    }
+
+    // A fifth of the chatters only have a login, as on lines without a user-id
+    std::vector<quint64> userIds(static_cast<size_t>(chatterCount));
+    std::vector<QString> logins(static_cast<size_t>(chatterCount));
+    for (int i = 0; i < chatterCount; ++i) {
+        userIds[static_cast<size_t>(i)] = i % 5 == 0 ? 0 : 100000 + static_cast<quint64>(i);
+        logins[static_cast<size_t>(i)] = QStringLiteral("chatter%1").arg(i);
+    }
+
+    // Messages drawn from the chatter pool with a long tail, like real chat
+    QRandomGenerator random(0x5eed);
+    std::vector<int> messages(static_cast<size_t>(messageCount));
+    for (int &chatter : messages) {
+        const quint32 a = random.bounded(static_cast<quint32>(chatterCount));
+        const quint32 b = random.bounded(static_cast<quint32>(chatterCount));
+        chatter = static_cast<int>(qMin(a, b));
+    }
+
+    std::printf("%d chatters, %d messages\n\n", chatterCount, messageCount);
+    std::printf("%-22s %12s %14s %12s\n", "stage", "ns/op", "ops/sec", "hits");
+
+    QElapsedTimer timer;
+
+    // Per-session dedup, then the lifetime lookup once per first sighting
+    {
+        ChatterTracker tracker;
+        tracker.openLifetimeIndex(directory.filePath(QStringLiteral("lifetime-bench.idx")));
+
+        quint64 firstSightings = 0;
+        timer.start();
+        for (int chatter : messages) {
+            const size_t i = static_cast<size_t>(chatter);
+            const quint64 key = ChatterKey::forChatter(userIds[i], logins[i]);
+            if (tracker.markSeen(key)) {
+                firstSightings++;
+                tracker.classify(key);
+            }
+        }
+        report("tracker dedup", timer.nsecsElapsed(), static_cast<quint64>(messageCount), firstSightings);
+    }
+
+    // Lifetime index on its own: cold inserts with growth, lookups, reopen
+    {
+        const QString path = directory.filePath(QStringLiteral("lifetime-cold.idx"));
+        LifetimeIndex index;
+        index.open(path);
+
+        quint64 inserted = 0;
+        timer.start();
+        for (int i = 0; i < chatterCount; ++i) {
+            const size_t at = static_cast<size_t>(i);
+            inserted += index.insert(ChatterKey::forChatter(userIds[at], logins[at]));
+        }
+        report("lifetime insert", timer.nsecsElapsed(), static_cast<quint64>(chatterCount), inserted);
+
+        quint64 found = 0;
+        timer.start();
+        for (int chatter : messages) {
+            const size_t i = static_cast<size_t>(chatter);
+            found += index.contains(ChatterKey::forChatter(userIds[i], logins[i]));
+        }
+        report("lifetime lookup", timer.nsecsElapsed(), static_cast<quint64>(messageCount), found);
+
+        index.close();
+        timer.start();
+        index.open(path);
+        report("lifetime reopen", timer.nsecsElapsed(), 1, index.size());
+    }
+
+    // Greeted journal: one record per greet or un-greet, then a cold replay
+    {
+        const QString journalDirectory = directory.filePath(QStringLiteral("greeted"));
+        const int toggles = qMin(chatterCount, messageCount);
+        QDir().mkpath(journalDirectory);
+        {
+            GreetedJournal journal(journalDirectory);
+            journal.load();
+
+            timer.start();
+            for (int i = 0; i < toggles; ++i) {
+                const size_t at = static_cast<size_t>(i);
+                const quint64 key = ChatterKey::forChatter(userIds[at], logins[at]);
+                if (i % 10 == 9) {
+                    journal.recordUngreeted(key);
+                } else {
+                    journal.recordGreeted(key);
+                }
+            }
+            journal.sync();
+            report("journal append", timer.nsecsElapsed(), static_cast<quint64>(toggles), 0);
+        }
+
+        GreetedJournal journal(journalDirectory);
+        timer.start();
+        const GreetedState state = journal.load();
+        report("journal replay", timer.nsecsElapsed(), static_cast<quint64>(toggles), state.keys.size());
+    }
+
+    // Session store: buffered appends written in the background, then the
+    // mapped load a restart does
+    {
+        const QString sessionDirectory = directory.filePath(QStringLiteral("session"));
+        QDir().mkpath(sessionDirectory);
+        {
+            SessionStore store(sessionDirectory);
+            store.load();
+
+            timer.start();
+            for (int i = 0; i < chatterCount; ++i) {
+                const size_t at = static_cast<size_t>(i);
+                ChatterRow row;
+                row.key = ChatterKey::forChatter(userIds[at], logins[at]);
+                row.displayName = logins[at];
+                row.seenAtMs = 1700000000000 + i;
+                row.newEver = i % 3 == 0;
+                store.append(row);
+            }
+            store.flush();
+            report("session append", timer.nsecsElapsed(), static_cast<quint64>(chatterCount), 0);
+        }
+
+        SessionStore store(sessionDirectory);
+        timer.start();
+        const std::vector<ChatterRow> rows = store.load();
+        report("session load", timer.nsecsElapsed(), static_cast<quint64>(chatterCount), rows.size());
+    }
+
+    // Name interning: every chatter once, then again as on a second day
+    {
+        ChatterRegistry registry;
+        quint64 repeats = 0;
+        timer.start();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const QString &login : logins) {
+                const size_t before = registry.count();
+                registry.intern(login);
+                repeats += registry.count() == before ? 1 : 0;
+            }
+        }
+        report("names intern", timer.nsecsElapsed(), 2 * static_cast<quint64>(chatterCount), repeats);
+    }
+
+    // List search: the prefix index built on restore, kept current by
+    // batched inserts, and the filter a keystroke in the search box sets
+    {
+        const int restored = chatterCount / 2;
+        std::vector<ChatterRow> rows(static_cast<size_t>(restored));
+        for (int i = 0; i < restored; ++i) {
+            const size_t at = static_cast<size_t>(i);
+            rows[at].key = ChatterKey::forChatter(userIds[at], logins[at]);
+            rows[at].displayName = logins[at];
+        }
+
+        ChatterListModel model;
+        timer.start();
+        model.restoreRows(std::move(rows));
+        report("search restore", timer.nsecsElapsed(), static_cast<quint64>(restored), 0);
+
+        // Raid-sized batches, one flush each, as the UI tick does
+        timer.start();
+        for (int i = restored; i < chatterCount; ++i) {
+            const size_t at = static_cast<size_t>(i);
+            model.enqueueChatter(ChatterKey::forChatter(userIds[at], logins[at]), logins[at], logins[at], false, false);
+            if (i % 200 == 199) {
+                model.flushPending();
+            }
+        }
+        model.flushPending();
+        report("search insert", timer.nsecsElapsed(), static_cast<quint64>(chatterCount - restored), 0);
+
+        // Every generated name starts with "chatter", so take one to four
+        // digits past it; hits shows how many rows the filters exposed
+        const int queries = 10000;
+        std::vector<QString> prefixes(static_cast<size_t>(queries));
+        for (QString &prefix : prefixes) {
+            const QString &login = logins[random.bounded(static_cast<quint32>(chatterCount))];
+            prefix = login.left(8 + static_cast<int>(random.bounded(4u)));
+        }
+        quint64 matches = 0;
+        timer.start();
+        for (const QString &prefix : prefixes) {
+            model.setFilter(prefix);
+            matches += static_cast<quint64>(model.rowCount());
+        }
+        report("search query", timer.nsecsElapsed(), static_cast<quint64>(queries), matches);
+        model.setFilter(QString());
+
+        const size_t bytes = model.registry().bytesUsed() + model.bytesUsed();
+        std::printf("\nchatter list: %d rows, %zu bytes per chatter (names, rows, search index)\n",
+                    model.rowCount(), bytes / static_cast<size_t>(model.rowCount()));
+    }
+
+    return 0;
+}
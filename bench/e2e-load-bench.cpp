@@ -0,0 +1,206 @@
+// End-to-end load test against a local mock Twitch server: generated chat
+// goes over a real WebSocket into TwitchIrcClient, IrcWorker, the lock-free
+// hand-off and ChatterListModel. Latency is measured from the server sending
+// a chatter's first message to that chatter's row being inserted. Rates are
+// stepped up until the pipeline falls behind.
+//
+//   e2e-load-bench [--rates 1000,5000,20000] [--seconds 3] [--unique 0.2]
+//                  [--raid SIZE:INTERVAL_MS] [--p99-limit-ms 100] [--direct]
+
+#include "mock-twitch-server.hpp"
+#include "irc-worker.hpp"
+#include "chatter-list-model.hpp"
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+static void runFor(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static bool waitFor(int timeoutMs, const std::function<bool()> &done)
+{
+    for (int waited = 0; waited < timeoutMs; waited += 10) {
+        if (done()) {
+            return true;
+        }
+        runFor(10);
+    }
+    return done();
+}
+
+static double percentileMs(std::vector<qint64> &samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<qptrdiff>(index), samples.end());
+    return samples[index] / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    QList<double> rates = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+    int seconds = 3;
+    double p99LimitMs = 100;
+    bool threaded = true;
+    MockChatProfile profile;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--rates") == 0 && hasValue) {
+            rates.clear();
+            const QStringList values = QString::fromLocal8Bit(argv[++i]).split(QLatin1Char(','), Qt::SkipEmptyParts);
+            for (const QString &value : values) {
+                rates.append(value.toDouble());
+            }
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--unique") == 0 && hasValue) {
+            profile.uniqueRatio = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--raid") == 0 && hasValue) {
+            const QStringList parts = QString::fromLocal8Bit(argv[++i]).split(QLatin1Char(':'));
+            profile.raidSize = parts.value(0).toInt();
+            profile.raidIntervalMs = parts.value(1, QStringLiteral("1000")).toInt();
+        } else if (std::strcmp(argv[i], "--p99-limit-ms") == 0 && hasValue) {
+            p99LimitMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--direct") == 0) {
+            threaded = false;
+        } else {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // ChatterListModel needs a GUI application for its fonts, but no screen
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    // The server gets its own thread so generating chat does not steal time
+    // from the pipeline under test
+    QThread serverThread;
+    auto *server = new MockTwitchServer();
+    server->moveToThread(&serverThread);
+    QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+    serverThread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(server, [server, &listening]() { listening = server->listen(); },
+                              Qt::BlockingQueuedConnection);
+    if (!listening) {
+        std::fprintf(stderr, "Mock server failed to listen\n");
+        serverThread.quit();
+        serverThread.wait();
+        return 1;
+    }
+
+    QTemporaryDir stateDirectory;
+    QThread networkThread;
+    auto *worker = new IrcWorker();
+    if (threaded) {
+        worker->moveToThread(&networkThread);
+        QObject::connect(&networkThread, &QThread::finished, worker, &QObject::deleteLater);
+        networkThread.start();
+    }
+    QMetaObject::invokeMethod(worker, "setStateDirectory", Q_ARG(QString, stateDirectory.path()));
+    QMetaObject::invokeMethod(worker, "setServerUrl", Q_ARG(QUrl, server->url()));
+    QMetaObject::invokeMethod(worker, "connectToTwitch",
+                              Q_ARG(QStringList, QStringList{QStringLiteral("loadtest")}),
+                              Q_ARG(QString, QStringLiteral("justinfan4242")),
+                              Q_ARG(QString, QStringLiteral("mock")));
+
+    // Drained exactly like the dock drains it
+    ChatterListModel model;
+    QObject::connect(worker, &IrcWorker::firstChattersAvailable, &app, [&]() {
+        worker->acknowledgeWakeup();
+        FirstChatterEvent event;
+        while (worker->popFirstChatter(event)) {
+            model.enqueueChatter(event.key, event.username, event.displayName, false, event.newEver);
+        }
+    });
+
+    std::vector<qint64> latencies;
+    quint64 rowsThisStep = 0;
+    QObject::connect(&model, &QAbstractItemModel::rowsInserted, &app, [&](const QModelIndex &, int first, int last) {
+        const qint64 now = IrcWorker::monotonicNs();
+        for (int row = first; row <= last; ++row) {
+            const quint64 userId = model.key(row);
+            const qint64 sentNs = server->firstMessageSentNs(userId);
+            if (sentNs >= 0) {
+                latencies.push_back(now - sentNs);
+            }
+        }
+        rowsThisStep += static_cast<quint64>(last - first + 1);
+    });
+
+    int exitCode = 0;
+    if (waitFor(5000, [server]() { return server->hasJoinedClient(); })) {
+        std::printf("mock server %s, %s network, unique %.2f, raid %d every %d ms, %d s per step\n\n",
+                    qPrintable(server->url().toString()), threaded ? "threaded" : "direct",
+                    profile.uniqueRatio, profile.raidSize, profile.raidIntervalMs, seconds);
+        std::printf("%10s %10s %10s %10s %10s %10s %10s\n",
+                    "msg/s", "sent/s", "new", "rows", "p50 ms", "p99 ms", "max ms");
+
+        double sustainable = 0;
+        for (double rate : rates) {
+            latencies.clear();
+            rowsThisStep = 0;
+            const quint64 sentBefore = server->messagesSent();
+            const quint64 newBefore = server->newChattersSent();
+
+            MockChatProfile step = profile;
+            step.messagesPerSecond = rate;
+            QMetaObject::invokeMethod(server, [server, step]() { server->setProfile(step); });
+            runFor(seconds * 1000);
+            QMetaObject::invokeMethod(server, [server]() { server->setProfile(MockChatProfile()); },
+                                      Qt::BlockingQueuedConnection);
+
+            const quint64 sent = server->messagesSent() - sentBefore;
+            const quint64 expected = server->newChattersSent() - newBefore;
+            waitFor(2000, [&]() { return rowsThisStep >= expected; });
+
+            const double p99 = percentileMs(latencies, 0.99);
+            std::printf("%10.0f %10.0f %10llu %10llu %10.2f %10.2f %10.2f\n",
+                        rate, double(sent) / seconds,
+                        static_cast<unsigned long long>(expected),
+                        static_cast<unsigned long long>(rowsThisStep),
+                        percentileMs(latencies, 0.5), p99, percentileMs(latencies, 1.0));
+
+            model.clear();
+            if (rowsThisStep < expected || p99 > p99LimitMs) {
+                break;
+            }
+            sustainable = rate;
+        }
+
+        std::printf("\nhighest sustainable rate: %.0f msg/s (all rows delivered, p99 <= %.0f ms)\n",
+                    sustainable, p99LimitMs);
+    } else {
+        std::fprintf(stderr, "Client never joined the mock server\n");
+        exitCode = 1;
+    }
+
+    QMetaObject::invokeMethod(worker, "disconnectFromTwitch", threaded ? Qt::BlockingQueuedConnection : Qt::DirectConnection);
+    if (threaded) {
+        networkThread.quit();
+        networkThread.wait();
+    } else {
+        delete worker;
+    }
+    serverThread.quit();
+    serverThread.wait();
+    return exitCode;
+}
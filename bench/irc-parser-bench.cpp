@@ -0,0 +1,244 @@
+// Parser throughput on recorded Twitch traffic: legacy QString parser, the
+// view-based tokenizer on every line, and command-first dispatch that only
+// tokenizes PRIVMSGs. Input is a text file with one IRC line per line.
+//
+//   irc-parser-bench [traffic.irc] [passes]
+
+#include "irc-message.hpp"
+#include "alloc-counter.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <cstdio>
+#include <cstdlib>
+
+// Lines per WebSocket frame; Twitch batches lines this way in busy channels
+static const int LINES_PER_FRAME = 8;
+
+struct BenchResult {
+    qint64 lines = 0;
+    qint64 privmsgs = 0;
+    qint64 nanoseconds = 0;
+    std::uint64_t allocations = 0;
+    qint64 checksum = 0;
+};
+
+// The parser as it shipped before IrcMessageView, kept verbatim for comparison
+static void legacyParseLine(const QString &rawMessage, BenchResult &result)
+{
+    if (rawMessage.startsWith(QStringLiteral("PING"))) {
+        return;
+    }
+
+    QString tags;
+    QString prefix;
+    QString command;
+    QString params;
+    QString trailing;
+
+    QString msg = rawMessage;
+
+    if (msg.startsWith('@')) {
+        int spaceIndex = msg.indexOf(' ');
+        if (spaceIndex != -1) {
+            tags = msg.mid(1, spaceIndex - 1);
+            msg = msg.mid(spaceIndex + 1);
+        }
+    }
+
+    if (msg.startsWith(':')) {
+        int spaceIndex = msg.indexOf(' ');
+        if (spaceIndex != -1) {
+            prefix = msg.mid(1, spaceIndex - 1);
+            msg = msg.mid(spaceIndex + 1);
+        }
+    }
+
+    int trailingIndex = msg.indexOf(QStringLiteral(" :"));
+    if (trailingIndex != -1) {
+        trailing = msg.mid(trailingIndex + 2);
+        msg = msg.left(trailingIndex);
+    }
+
+    QStringList parts = msg.split(' ', Qt::SkipEmptyParts);
+    if (!parts.isEmpty()) {
+        command = parts.takeFirst();
+        params = parts.join(' ');
+    }
+
+    if (command == QStringLiteral("PRIVMSG")) {
+        QString username;
+        QString displayName;
+
+        if (!tags.isEmpty()) {
+            QStringList tagList = tags.split(';');
+            for (const QString &tag : tagList) {
+                int eqIndex = tag.indexOf('=');
+                if (eqIndex != -1) {
+                    QString key = tag.left(eqIndex);
+                    QString value = tag.mid(eqIndex + 1);
+                    if (key == QStringLiteral("display-name")) {
+                        displayName = value;
+                    }
+                }
+            }
+        }
+
+        if (!prefix.isEmpty()) {
+            int exclamIndex = prefix.indexOf('!');
+            if (exclamIndex != -1) {
+                username = prefix.left(exclamIndex);
+            } else {
+                username = prefix;
+            }
+        }
+
+        if (displayName.isEmpty()) {
+            displayName = username;
+        }
+
+        if (!username.isEmpty()) {
+            QString lowered = username.toLower();
+            result.privmsgs++;
+            result.checksum += lowered.size() + displayName.size() + trailing.size();
+        }
+    }
+}
+
+static void legacyParseFrame(const QString &frame, BenchResult &result)
+{
+    QStringList lines = frame.split(QStringLiteral("\r\n"), Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        result.lines++;
+        legacyParseLine(line, result);
+    }
+}
+
+// What the dock's receiver copies out of a PRIVMSG
+static void consumePrivmsg(const IrcMessageView &msg, BenchResult &result)
+{
+    QStringView nick = msg.nick();
+    if (nick.isEmpty()) {
+        return;
+    }
+
+    QString username = nick.toString().toLower();
+    QString displayName = msg.tagValue(u"display-name");
+    if (displayName.isEmpty()) {
+        displayName = username;
+    }
+    QString message = msg.trailing.toString();
+
+    result.privmsgs++;
+    result.checksum += username.size() + displayName.size() + message.size();
+}
+
+// Full parse of every line, as the client did before command-first dispatch
+static void viewParseFrame(const QString &frame, BenchResult &result)
+{
+    forEachIrcLine(frame, [&result](QStringView line) {
+        result.lines++;
+        if (line.startsWith(QStringView(u"PING"))) {
+            return;
+        }
+
+        IrcMessageView msg;
+        if (!msg.parse(line) || msg.command != QStringView(u"PRIVMSG")) {
+            return;
+        }
+
+        consumePrivmsg(msg, result);
+    });
+}
+
+// Mirrors TwitchIrcClient::dispatchLine
+static void dispatchParseFrame(const QString &frame, BenchResult &result)
+{
+    forEachIrcLine(frame, [&result](QStringView line) {
+        result.lines++;
+        if (ircCommandOf(ircCommandToken(line)) != IrcCommand::Privmsg) {
+            return;
+        }
+
+        IrcMessageView msg;
+        if (msg.parse(line)) {
+            consumePrivmsg(msg, result);
+        }
+    });
+}
+
+template<typename ParseFn>
+static BenchResult runPasses(const QStringList &frames, int passes, ParseFn parseFrame)
+{
+    BenchResult result;
+    std::uint64_t allocationsBefore = AllocCounter::count();
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const QString &frame : frames) {
+            parseFrame(frame, result);
+        }
+    }
+
+    result.nanoseconds = timer.nsecsElapsed();
+    result.allocations = AllocCounter::count() - allocationsBefore;
+    return result;
+}
+
+static void printResult(const char *name, const BenchResult &result)
+{
+    double seconds = result.nanoseconds / 1e9;
+    std::printf("%-8s %14.0f %14.2f %12.1f %12lld\n",
+                name,
+                result.lines / seconds,
+                double(result.allocations) / double(result.lines),
+                double(result.nanoseconds) / double(result.lines),
+                static_cast<long long>(result.checksum));
+}
+
+int main(int argc, char **argv)
+{
+    QString path = argc > 1 ? QString::fromLocal8Bit(argv[1])
+                            : QStringLiteral(FTC_BENCH_DATA_DIR "/twitch-raid-sample.irc");
+    int passes = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s\n", qPrintable(path));
+        return 1;
+    }
+
+    QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    QStringList frames;
+    for (int i = 0; i < lines.size(); i += LINES_PER_FRAME) {
+        frames.append(lines.mid(i, LINES_PER_FRAME).join(QStringLiteral("\r\n")) + QStringLiteral("\r\n"));
+    }
+
+    std::printf("%lld lines in %lld frames, %d passes\n\n",
+                static_cast<long long>(lines.size()), static_cast<long long>(frames.size()), passes);
+    std::printf("%-8s %14s %14s %12s %12s\n", "parser", "lines/sec", "allocs/line", "ns/line", "checksum");
+
+    // Warm up every path once so first-touch costs do not skew the legacy run
+    runPasses(frames, 1, legacyParseFrame);
+    runPasses(frames, 1, viewParseFrame);
+    runPasses(frames, 1, dispatchParseFrame);
+
+    printResult("legacy", runPasses(frames, passes, legacyParseFrame));
+    printResult("view", runPasses(frames, passes, viewParseFrame));
+    printResult("dispatch", runPasses(frames, passes, dispatchParseFrame));
+
+    // What the traffic is made of
+    quint64 counts[IrcCommandCount] = {};
+    for (const QString &line : std::as_const(lines)) {
+        counts[static_cast<int>(ircCommandOf(ircCommandToken(line)))]++;
+    }
+    std::printf("\n");
+    for (int i = 0; i < IrcCommandCount; ++i) {
+        if (counts[i] > 0) {
+            std::printf("%-16s %10llu\n", ircCommandName(static_cast<IrcCommand>(i)),
+                        static_cast<unsigned long long>(counts[i]));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Replays a capture through the plugin's own pipeline with no network:
+// TwitchIrcClient parsing, IrcWorker bot filter and dedup, the lock-free
+// hand-off and ChatterListModel batching, drained the way the dock drains.
+//
+//   irc-replay <capture.ftcap> [speed] [--threaded]
+//       speed 1 replays in real time, 10 ten times faster, 0 unpaced
+//   irc-replay --convert <traffic.irc> <capture.ftcap> [frame-interval-us]
+//       builds a capture from a text file with one IRC line per line
+
+#include "irc-capture.hpp"
+#include "irc-message.hpp"
+#include "irc-worker.hpp"
+#include "chatter-list-model.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Lines per WebSocket frame when converting, as in irc-parser-bench
+static const int LINES_PER_FRAME = 8;
+
+static int convert(const QString &input, const QString &output, qint64 intervalNs)
+{
+    QFile file(input);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s\n", qPrintable(input));
+        return 1;
+    }
+
+    IrcCaptureWriter writer;
+    if (!writer.open(output)) {
+        std::fprintf(stderr, "Cannot write %s\n", qPrintable(output));
+        return 1;
+    }
+
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    qint64 timestampNs = 0;
+    for (int i = 0; i < lines.size(); i += LINES_PER_FRAME) {
+        writer.write(timestampNs, lines.mid(i, LINES_PER_FRAME).join(QStringLiteral("\r\n")) + QStringLiteral("\r\n"));
+        timestampNs += intervalNs;
+    }
+
+    std::printf("%llu frames written to %s\n", static_cast<unsigned long long>(writer.frameCount()), qPrintable(output));
+    return 0;
+}
+
+static double percentileUs(std::vector<qint64> &samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<qptrdiff>(index), samples.end());
+    return samples[index] / 1000.0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 3 && std::strcmp(argv[1], "--convert") == 0) {
+        qint64 intervalUs = argc > 4 ? std::atoll(argv[4]) : 2000;
+        return convert(QString::fromLocal8Bit(argv[2]), QString::fromLocal8Bit(argv[3]), intervalUs * 1000);
+    }
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: irc-replay <capture.ftcap> [speed] [--threaded]\n"
+                             "       irc-replay --convert <traffic.irc> <capture.ftcap> [frame-interval-us]\n");
+        return 1;
+    }
+
+    // ChatterListModel needs a GUI application for its fonts, but no screen
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    const QString path = QString::fromLocal8Bit(argv[1]);
+    const double speed = argc > 2 && argv[2][0] != '-' ? std::atof(argv[2]) : 0;
+    bool threaded = false;
+    for (int i = 2; i < argc; ++i) {
+        threaded |= std::strcmp(argv[i], "--threaded") == 0;
+    }
+
+    // Join every channel that appears in the capture
+    IrcCaptureReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "Cannot open capture %s\n", qPrintable(path));
+        return 1;
+    }
+    QStringList channels;
+    quint64 frameCount = 0;
+    quint64 lineCount = 0;
+    IrcCaptureFrame frame;
+    while (reader.next(frame)) {
+        frameCount++;
+        forEachIrcLine(frame.text, [&](QStringView line) {
+            lineCount++;
+            IrcMessageView message;
+            if (message.parse(line) && message.command == QStringView(u"PRIVMSG") &&
+                message.params.startsWith(u'#') && !channels.contains(message.params.sliced(1))) {
+                channels.append(message.params.sliced(1).toString());
+            }
+        });
+    }
+    reader.close();
+
+    // Lifetime indexes go to a scratch directory so every run starts cold
+    QTemporaryDir stateDirectory;
+    QThread networkThread;
+    auto *worker = new IrcWorker();
+    if (threaded) {
+        worker->moveToThread(&networkThread);
+        QObject::connect(&networkThread, &QThread::finished, worker, &QObject::deleteLater);
+        networkThread.start();
+    }
+    QMetaObject::invokeMethod(worker, "setStateDirectory", Q_ARG(QString, stateDirectory.path()));
+    QMetaObject::invokeMethod(worker, "setChannels", Q_ARG(QStringList, channels));
+
+    ChatterListModel model;
+    std::vector<qint64> endToEndNs;
+    std::vector<qint64> handOffNs;
+
+    auto drain = [&]() {
+        worker->acknowledgeWakeup();
+        FirstChatterEvent event;
+        while (worker->popFirstChatter(event)) {
+            const qint64 now = IrcWorker::monotonicNs();
+            endToEndNs.push_back(now - event.receivedNs);
+            handOffNs.push_back(now - event.enqueuedNs);
+            model.enqueueChatter(event.key, event.username, event.displayName, false, event.newEver);
+        }
+    };
+    QObject::connect(worker, &IrcWorker::firstChattersAvailable, &app, drain);
+
+    quint64 replayedFrames = 0;
+    qint64 replayNs = 0;
+    QObject::connect(worker, &IrcWorker::replayFinished, &app, [&](quint64 frames, qint64 elapsedNs) {
+        replayedFrames = frames;
+        replayNs = elapsedNs;
+        // Let in-flight events and the model's batch timer settle
+        QTimer::singleShot(50, &app, [&]() {
+            drain();
+            model.flushPending();
+            app.quit();
+        });
+    });
+
+    const PipelineStats::Snapshot statsBefore = worker->stats().snapshot(IrcWorker::monotonicNs());
+    QElapsedTimer wallClock;
+    wallClock.start();
+    QMetaObject::invokeMethod(worker, "replayCapture", Q_ARG(QString, path), Q_ARG(double, speed));
+    app.exec();
+
+    const quint64 spilled = worker->overflowCount();
+    const PipelineStats::Snapshot statsAfter = worker->stats().snapshot(IrcWorker::monotonicNs());
+    quint64 commandCounts[IrcCommandCount];
+    for (int i = 0; i < IrcCommandCount; ++i) {
+        commandCounts[i] = worker->commandCount(static_cast<IrcCommand>(i));
+    }
+    if (threaded) {
+        networkThread.quit();
+        networkThread.wait();
+    } else {
+        delete worker;
+    }
+
+    const double seconds = replayNs / 1e9;
+    std::printf("%s: %llu frames, %llu lines, %lld channels, speed %s, %s network\n\n",
+                qPrintable(path),
+                static_cast<unsigned long long>(frameCount),
+                static_cast<unsigned long long>(lineCount),
+                static_cast<long long>(channels.size()),
+                speed > 0 ? qPrintable(QString::number(speed) + QLatin1Char('x')) : "unpaced",
+                threaded ? "threaded" : "direct");
+    if (replayedFrames == 0 || seconds <= 0) {
+        std::fprintf(stderr, "Replay failed\n");
+        return 1;
+    }
+
+    std::printf("replay        %10.3f s  (%lld ms wall)\n", seconds, static_cast<long long>(wallClock.elapsed()));
+    std::printf("throughput    %10.0f lines/s  %10.0f frames/s\n", lineCount / seconds, replayedFrames / seconds);
+    std::printf("first chat    %10lld events, %d rows, %llu spilled\n",
+                static_cast<long long>(endToEndNs.size()), model.rowCount(),
+                static_cast<unsigned long long>(spilled));
+    std::printf("receive->dock p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                percentileUs(endToEndNs, 0.5), percentileUs(endToEndNs, 0.99), percentileUs(endToEndNs, 1.0));
+    std::printf("hand-off      p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                percentileUs(handOffNs, 0.5), percentileUs(handOffNs, 0.99), percentileUs(handOffNs, 1.0));
+
+    // Only the network-side stages; this tool drains without the dock
+    std::printf("\npipeline stages\n%s\n", qPrintable(PipelineStats::summary(statsBefore, statsAfter)));
+
+    std::printf("\nlines by command\n");
+    for (int i = 0; i < IrcCommandCount; ++i) {
+        if (commandCounts[i] > 0) {
+            std::printf("  %-16s %10llu\n", ircCommandName(static_cast<IrcCommand>(i)),
+                        static_cast<unsigned long long>(commandCounts[i]));
+        }
+    }
+    return 0;
+}
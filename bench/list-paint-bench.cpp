@@ -0,0 +1,176 @@
+// Paint and scroll frame times of the chatter list at dock scale: the same
+// ChatterListModel and QListView setup as the dock, drawn by ChatterDelegate
+// and, for comparison, by QStyledItemDelegate with per-row font and brush
+// roles under the dark theme's QListView::item stylesheet rules, which is
+// how rows used to be drawn.
+//
+//   list-paint-bench [rows] [frames]
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise.
+
+#include "chatter-delegate.hpp"
+#include "chatter-list-model.hpp"
+#include <QApplication>
+#include <QBrush>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QIdentityProxyModel>
+#include <QImage>
+#include <QListView>
+#include <QRandomGenerator>
+#include <QScrollBar>
+#include <QStyledItemDelegate>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+static const QString LIST_STYLE = QStringLiteral(
+    "QListView { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; }");
+static const QString LEGACY_ITEM_STYLE = QStringLiteral(
+    "QListView::item { padding: 6px 8px; border-bottom: 1px solid #2d2d32; }"
+    "QListView::item:hover { background-color: #26262c; }");
+
+// Serves the font and foreground roles the model used to return per row
+class LegacyRolesModel : public QIdentityProxyModel {
+public:
+    explicit LegacyRolesModel(QObject *parent = nullptr)
+        : QIdentityProxyModel(parent)
+    {
+        m_greetedFont.setStrikeOut(true);
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (role == Qt::FontRole) {
+            return index.data(ChatterListModel::GreetedRole).toBool() ? QVariant(m_greetedFont) : QVariant();
+        }
+        if (role == Qt::ForegroundRole) {
+            if (index.data(ChatterListModel::GreetedRole).toBool()) {
+                return QBrush(QColor(0x7a, 0x7a, 0x7d));
+            }
+            return QBrush(index.data(ChatterListModel::NewEverRole).toBool() ? QColor(0xbf, 0x94, 0xff)
+                                                                             : QColor(0xef, 0xef, 0xf1));
+        }
+        return QIdentityProxyModel::data(index, role);
+    }
+
+private:
+    QFont m_greetedFont;
+};
+
+static double percentileUs(std::vector<qint64> &samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<qptrdiff>(index), samples.end());
+    return samples[index] / 1000.0;
+}
+
+static void report(const char *delegate, const char *stage, std::vector<qint64> &frames)
+{
+    std::printf("%-10s %-8s %10.1f %10.1f %10.1f\n", delegate, stage, percentileUs(frames, 0.5),
+                percentileUs(frames, 0.99), percentileUs(frames, 1.0));
+}
+
+// Renders the viewport once per frame after moving the scroll bar with step
+static std::vector<qint64> measure(QListView &view, int frames, const std::function<int(int frame, int maximum)> &step)
+{
+    QWidget *viewport = view.viewport();
+    QImage image(viewport->size(), QImage::Format_ARGB32_Premultiplied);
+    QScrollBar *scrollBar = view.verticalScrollBar();
+
+    std::vector<qint64> times;
+    times.reserve(static_cast<size_t>(frames));
+    QElapsedTimer timer;
+    for (int frame = 0; frame < frames; ++frame) {
+        timer.start();
+        scrollBar->setValue(step(frame, scrollBar->maximum()));
+        viewport->render(&image);
+        times.push_back(timer.nsecsElapsed());
+    }
+    return times;
+}
+
+int main(int argc, char **argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    const int rowCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int frameCount = argc > 2 ? std::atoi(argv[2]) : 600;
+    if (rowCount <= 0 || frameCount <= 0) {
+        std::fprintf(stderr, "usage: list-paint-bench [rows] [frames]\n");
+        return 1;
+    }
+
+    // A third greeted and a few new-ever, with the odd name too long to fit
+    std::vector<ChatterRow> rows(static_cast<size_t>(rowCount));
+    for (int i = 0; i < rowCount; ++i) {
+        ChatterRow &row = rows[static_cast<size_t>(i)];
+        row.key = 100000 + static_cast<quint64>(i);
+        row.displayName = i % 50 == 0 ? QStringLiteral("AVeryLongDisplayNameThatGetsElided%1").arg(i)
+                                      : QStringLiteral("Chatter%1").arg(i);
+        row.seenAtMs = 1700000000000ll + i * 100ll;
+        row.greeted = i % 3 == 0;
+        row.newEver = i % 7 == 0;
+    }
+
+    ChatterListModel model;
+    QElapsedTimer timer;
+    timer.start();
+    model.restoreRows(rows);
+    const qint64 restoreNs = timer.nsecsElapsed();
+
+    std::printf("%d rows, %d frames per stage; restore %.1f ms, %zu bytes per row record\n\n", rowCount,
+                frameCount, restoreNs / 1e6, sizeof(ChatterRecord));
+    std::printf("%-10s %-8s %10s %10s %10s\n", "delegate", "frame", "p50 us", "p99 us", "max us");
+
+    LegacyRolesModel legacyModel;
+    legacyModel.setSourceModel(&model);
+
+    QRandomGenerator random(0x5eed);
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool legacy = pass == 0;
+
+        QListView view;
+        view.setSelectionMode(QAbstractItemView::NoSelection);
+        view.setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+        view.setUniformItemSizes(true);
+        view.setStyleSheet(legacy ? LIST_STYLE + LEGACY_ITEM_STYLE : LIST_STYLE);
+        if (legacy) {
+            view.setModel(&legacyModel);
+        } else {
+            view.setItemDelegate(new ChatterDelegate(&view));
+            view.setModel(&model);
+        }
+        view.resize(320, 800);
+        view.show();
+        QApplication::processEvents();
+
+        const char *name = legacy ? "styled" : "chatter";
+
+        // Repaints of the same rows, as on hover or a greet click
+        std::vector<qint64> still = measure(view, frameCount, [](int, int) { return 0; });
+        report(name, "still", still);
+
+        // A steady wheel scroll down from the top
+        std::vector<qint64> scroll = measure(view, frameCount, [](int frame, int maximum) {
+            return qMin(maximum, frame * 40);
+        });
+        report(name, "scroll", scroll);
+
+        // Dragging the scroll bar across the whole list
+        std::vector<qint64> jump = measure(view, frameCount, [&random](int, int maximum) {
+            return static_cast<int>(random.bounded(maximum + 1));
+        });
+        report(name, "jump", jump);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include "mock-twitch-server.hpp"
+#include "irc-message.hpp"
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHostAddress>
+#include <QMutexLocker>
+#include <algorithm>
+#include <iterator>
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+static const char *const MESSAGES[] = {
+    "hello chat",
+    "first time here, love the stream",
+    "PogChamp that was clean",
+    "gg",
+    "what game is this?",
+    "LUL",
+    "hi from the raid!",
+    "this song slaps",
+};
+
+MockTwitchServer::MockTwitchServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QWebSocketServer(QStringLiteral("mock-tmi"), QWebSocketServer::NonSecureMode, this))
+    , m_tickTimer(new QTimer(this))
+    , m_random(0x5eed)
+{
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_server, &QWebSocketServer::newConnection, this, &MockTwitchServer::onNewConnection);
+    connect(m_tickTimer, &QTimer::timeout, this, &MockTwitchServer::generate);
+}
+
+MockTwitchServer::~MockTwitchServer()
+{
+    m_server->close();
+}
+
+bool MockTwitchServer::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        return false;
+    }
+    m_url = QUrl(QStringLiteral("ws://127.0.0.1:%1").arg(m_server->serverPort()));
+    return true;
+}
+
+void MockTwitchServer::setProfile(const MockChatProfile &profile)
+{
+    m_profile = profile;
+    m_profileStartNs = nowNs();
+    m_lastRaidNs = m_profileStartNs;
+    m_generatedThisProfile = 0;
+    m_uniqueCredit = 0;
+
+    if (m_profile.messagesPerSecond > 0) {
+        m_tickTimer->start(qMax(1, m_profile.tickMs));
+    } else {
+        m_tickTimer->stop();
+    }
+}
+
+qint64 MockTwitchServer::firstMessageSentNs(quint64 userId) const
+{
+    QMutexLocker locker(&m_rangesMutex);
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), userId,
+                               [](quint64 id, const SentRange &range) { return id < range.firstUserId; });
+    if (it == m_ranges.begin()) {
+        return -1;
+    }
+    --it;
+    return userId < it->firstUserId + it->count ? it->sentNs : -1;
+}
+
+void MockTwitchServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QWebSocket *socket = m_server->nextPendingConnection();
+        connect(socket, &QWebSocket::textMessageReceived, this, &MockTwitchServer::onTextMessage);
+        connect(socket, &QWebSocket::disconnected, this, &MockTwitchServer::onDisconnected);
+        m_clients.append(socket);
+    }
+}
+
+void MockTwitchServer::onTextMessage(const QString &frame)
+{
+    auto *socket = qobject_cast<QWebSocket *>(sender());
+    if (!socket) {
+        return;
+    }
+    forEachIrcLine(frame, [this, socket](QStringView line) {
+        handleLine(socket, line);
+    });
+}
+
+void MockTwitchServer::onDisconnected()
+{
+    auto *socket = qobject_cast<QWebSocket *>(sender());
+    m_clients.removeAll(socket);
+    if (socket) {
+        socket->deleteLater();
+    }
+    if (m_clients.isEmpty()) {
+        m_channels.clear();
+        m_joined.store(false, std::memory_order_release);
+    }
+}
+
+void MockTwitchServer::handleLine(QWebSocket *socket, QStringView line)
+{
+    IrcMessageView message;
+    if (!message.parse(line)) {
+        return;
+    }
+
+    const QString nick = socket->property("nick").toString();
+    if (message.command == QStringView(u"CAP")) {
+        socket->sendTextMessage(QStringLiteral(":tmi.twitch.tv CAP * ACK :%1").arg(message.trailing));
+    } else if (message.command == QStringView(u"NICK")) {
+        const QString name = message.params.toString().toLower();
+        socket->setProperty("nick", name);
+        socket->sendTextMessage(QStringLiteral(":tmi.twitch.tv 001 %1 :Welcome, GLHF!\r\n"
+                                               ":tmi.twitch.tv 376 %1 :>").arg(name));
+    } else if (message.command == QStringView(u"JOIN")) {
+        const QStringList channels = message.params.toString().split(QLatin1Char(','), Qt::SkipEmptyParts);
+        QString reply;
+        for (const QString &channel : channels) {
+            if (!m_channels.contains(channel)) {
+                m_channels.append(channel);
+            }
+            reply += QStringLiteral(":%1!%1@%1.tmi.twitch.tv JOIN %2\r\n"
+                                    ":%1.tmi.twitch.tv 353 %1 = %2 :%1\r\n"
+                                    ":%1.tmi.twitch.tv 366 %1 %2 :End of /NAMES list\r\n").arg(nick, channel);
+        }
+        socket->sendTextMessage(reply);
+        m_joined.store(!m_channels.isEmpty(), std::memory_order_release);
+    } else if (message.command == QStringView(u"PART")) {
+        const QStringList channels = message.params.toString().split(QLatin1Char(','), Qt::SkipEmptyParts);
+        for (const QString &channel : channels) {
+            m_channels.removeAll(channel);
+        }
+    } else if (message.command == QStringView(u"PING")) {
+        socket->sendTextMessage(QStringLiteral(":tmi.twitch.tv PONG tmi.twitch.tv :%1").arg(message.trailing));
+    }
+}
+
+void MockTwitchServer::appendPrivmsg(QString &frame, quint64 userId)
+{
+    // Same tag set and order as real Twitch PRIVMSGs
+    const QString login = QStringLiteral("load%1").arg(userId);
+    const quint64 messageId = ++m_messageId;
+    frame += QStringLiteral("@badge-info=;badges=;color=#1E90FF;display-name=Load%1;emotes=;first-msg=0;flags=;"
+                            "id=%2;mod=0;returning-chatter=0;room-id=1;subscriber=0;tmi-sent-ts=%3;turbo=0;"
+                            "user-id=%1;user-type= :%4!%4@%4.tmi.twitch.tv PRIVMSG %5 :%6\r\n")
+                 .arg(userId)
+                 .arg(messageId)
+                 .arg(QDateTime::currentMSecsSinceEpoch())
+                 .arg(login, m_channels.first(), QLatin1String(MESSAGES[messageId % std::size(MESSAGES)]));
+}
+
+void MockTwitchServer::generate()
+{
+    if (m_clients.isEmpty() || m_channels.isEmpty()) {
+        return;
+    }
+
+    const qint64 now = nowNs();
+    const quint64 due = static_cast<quint64>((now - m_profileStartNs) * m_profile.messagesPerSecond / 1e9);
+    const quint64 count = due > m_generatedThisProfile ? due - m_generatedThisProfile : 0;
+    m_generatedThisProfile += count;
+
+    quint64 raidCount = 0;
+    if (m_profile.raidIntervalMs > 0 && now - m_lastRaidNs >= qint64(m_profile.raidIntervalMs) * 1000000) {
+        raidCount = static_cast<quint64>(m_profile.raidSize);
+        m_lastRaidNs = now;
+    }
+    if (count + raidCount == 0) {
+        return;
+    }
+
+    // All generated chat goes to the first joined channel
+    const quint64 firstNewUserId = m_nextUserId;
+    QString frame;
+    frame.reserve(static_cast<qsizetype>((count + raidCount) * 300));
+    for (quint64 i = 0; i < count; ++i) {
+        m_uniqueCredit += m_profile.uniqueRatio;
+        quint64 userId;
+        if (m_uniqueCredit >= 1.0 || m_nextUserId == m_firstUserId) {
+            m_uniqueCredit = qMax(0.0, m_uniqueCredit - 1.0);
+            userId = m_nextUserId++;
+        } else {
+            userId = m_firstUserId + m_random.bounded(m_nextUserId - m_firstUserId);
+        }
+        appendPrivmsg(frame, userId);
+    }
+    for (quint64 i = 0; i < raidCount; ++i) {
+        appendPrivmsg(frame, m_nextUserId++);
+    }
+
+    const qint64 sentNs = nowNs();
+    for (QWebSocket *socket : std::as_const(m_clients)) {
+        socket->sendTextMessage(frame);
+    }
+
+    const quint64 newChatters = m_nextUserId - firstNewUserId;
+    if (newChatters > 0) {
+        QMutexLocker locker(&m_rangesMutex);
+        m_ranges.push_back(SentRange{firstNewUserId, static_cast<quint32>(newChatters), sentNs});
+    }
+    m_messagesSent.fetch_add(count + raidCount, std::memory_order_relaxed);
+    m_newChattersSent.fetch_add(newChatters, std::memory_order_relaxed);
+}
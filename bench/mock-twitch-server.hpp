@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QUrl>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <atomic>
+#include <vector>
+
+// Shape of the synthetic chat a MockTwitchServer produces
+struct MockChatProfile {
+    double messagesPerSecond = 0;  // 0 pauses generation
+    double uniqueRatio = 0.2;      // Share of messages from chatters never sent before
+    int raidSize = 0;              // New chatters per raid burst
+    int raidIntervalMs = 0;        // 0 disables raids
+    int tickMs = 5;                // Messages due within one tick share a frame
+};
+
+// Local stand-in for irc-ws.chat.twitch.tv. It speaks enough of the Twitch
+// IRC dialect for TwitchIrcClient (CAP, PASS/NICK, JOIN, PING/PONG, tagged
+// PRIVMSG) and streams generated chat to every joined channel.
+//
+// New chatters get sequential user-ids, so the send time of each one's first
+// message is kept as a compact list of ranges that a load test can look up
+// to measure message-to-row latency.
+class MockTwitchServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit MockTwitchServer(QObject *parent = nullptr);
+    ~MockTwitchServer() override;
+
+    // Call on the server's thread; port 0 picks a free one
+    bool listen(quint16 port = 0);
+    QUrl url() const { return m_url; }
+
+    // Call on the server's thread, e.g. through a queued functor
+    void setProfile(const MockChatProfile &profile);
+
+    // Thread-safe
+    quint64 messagesSent() const { return m_messagesSent.load(std::memory_order_relaxed); }
+    quint64 newChattersSent() const { return m_newChattersSent.load(std::memory_order_relaxed); }
+    bool hasJoinedClient() const { return m_joined.load(std::memory_order_acquire); }
+    // Monotonic send time of the first message by userId, or -1 if unknown
+    qint64 firstMessageSentNs(quint64 userId) const;
+
+private slots:
+    void onNewConnection();
+    void onTextMessage(const QString &frame);
+    void onDisconnected();
+    void generate();
+
+private:
+    struct SentRange {
+        quint64 firstUserId;
+        quint32 count;
+        qint64 sentNs;
+    };
+
+    void handleLine(QWebSocket *socket, QStringView line);
+    void appendPrivmsg(QString &frame, quint64 userId);
+
+    QWebSocketServer *m_server;
+    QList<QWebSocket *> m_clients;
+    QStringList m_channels;
+    QUrl m_url;
+    QTimer *m_tickTimer;
+    QRandomGenerator m_random;
+
+    MockChatProfile m_profile;
+    qint64 m_profileStartNs = 0;
+    qint64 m_lastRaidNs = 0;
+    quint64 m_generatedThisProfile = 0;
+    double m_uniqueCredit = 0;
+    quint64 m_nextUserId = 100000;
+    quint64 m_firstUserId = 100000;
+    quint64 m_messageId = 0;
+
+    mutable QMutex m_rangesMutex;
+    std::vector<SentRange> m_ranges;
+
+    std::atomic<quint64> m_messagesSent{0};
+    std::atomic<quint64> m_newChattersSent{0};
+    std::atomic<bool> m_joined{false};
+};
@@ -0,0 +1,221 @@
+// Drives the overlay server with synthetic chatters and watches it with a
+// local WebSocket client, the way an OBS browser source would, with no
+// Twitch connection. Reports add-to-client latency and batching, and checks
+// the snapshot, resume and HTTP paths; exits non-zero if a check fails.
+//
+//   overlay-bench [chatters/sec] [seconds]
+
+#include "overlay-server.hpp"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QWebSocket>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+static bool waitUntil(const std::function<bool()> &done, int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    while (!done()) {
+        if (deadline.hasExpired()) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+static double percentileMs(std::vector<qint64> &samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<qptrdiff>(index), samples.end());
+    return samples[index] / 1e6;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    std::printf("  %-44s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) {
+        failures++;
+    }
+}
+
+// What a browser source would track: the last seq and the messages seen
+struct OverlayClient {
+    QWebSocket socket;
+    quint64 seq = 0;
+    int snapshots = 0;
+    int batches = 0;
+    int addedEvents = 0;
+    int snapshotChatters = 0;
+    std::function<void(const QJsonObject &event)> onEvent;
+
+    OverlayClient()
+    {
+        QObject::connect(&socket, &QWebSocket::textMessageReceived, [this](const QString &text) {
+            const QJsonObject message = QJsonDocument::fromJson(text.toUtf8()).object();
+            seq = static_cast<quint64>(message.value(QStringLiteral("seq")).toInteger());
+            if (message.value(QStringLiteral("type")) == QStringLiteral("snapshot")) {
+                snapshots++;
+                snapshotChatters = static_cast<int>(message.value(QStringLiteral("chatters")).toArray().size());
+                return;
+            }
+            batches++;
+            for (const QJsonValue &value : message.value(QStringLiteral("events")).toArray()) {
+                const QJsonObject event = value.toObject();
+                if (event.value(QStringLiteral("op")) == QStringLiteral("added")) {
+                    addedEvents++;
+                }
+                if (onEvent) {
+                    onEvent(event);
+                }
+            }
+        });
+    }
+
+    bool open(quint16 port, const QString &query = QString())
+    {
+        socket.open(QUrl(QStringLiteral("ws://127.0.0.1:%1/ws%2").arg(port).arg(query)));
+        return waitUntil([this]() { return socket.state() == QAbstractSocket::ConnectedState; }, 2000);
+    }
+
+    void close()
+    {
+        socket.close();
+        waitUntil([this]() { return socket.state() == QAbstractSocket::UnconnectedState; }, 2000);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    const int rate = argc > 1 ? std::atoi(argv[1]) : 500;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (rate <= 0 || seconds <= 0) {
+        std::fprintf(stderr, "usage: overlay-bench [chatters/sec] [seconds]\n");
+        return 1;
+    }
+
+    OverlayServer server;
+    if (!server.listen(0)) {
+        std::fprintf(stderr, "Cannot listen on localhost\n");
+        return 1;
+    }
+    const quint16 port = server.port();
+    std::printf("overlay on 127.0.0.1:%u, %d chatters/sec for %d s\n\n", port, rate, seconds);
+
+    quint64 nextKey = 1;
+    auto addChatters = [&server, &nextKey](int count) {
+        for (int i = 0; i < count; ++i, ++nextKey) {
+            server.chatterAdded(QStringLiteral("bench"), nextKey, QStringLiteral("Chatter%1").arg(nextKey), nextKey % 7 == 0,
+                                false);
+        }
+    };
+
+    // Streaming: latency from chatterAdded to the client parsing the event
+    OverlayClient client;
+    QHash<quint64, qint64> addedAtNs;
+    std::vector<qint64> latencies;
+    client.onEvent = [&addedAtNs, &latencies](const QJsonObject &event) {
+        const quint64 key = event.value(QStringLiteral("id")).toString().toULongLong();
+        const auto it = addedAtNs.constFind(key);
+        if (it != addedAtNs.cend()) {
+            latencies.push_back(nowNs() - it.value());
+        }
+    };
+    if (!client.open(port)) {
+        std::fprintf(stderr, "Client could not connect\n");
+        return 1;
+    }
+    waitUntil([&client]() { return client.snapshots > 0; }, 2000);
+
+    const int total = rate * seconds;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    int sent = 0;
+    QTimer feeder;
+    feeder.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&feeder, &QTimer::timeout, [&]() {
+        const int due = qMin(total, static_cast<int>(elapsed.nsecsElapsed() * rate / 1000000000));
+        for (; sent < due; ++sent) {
+            addedAtNs.insert(nextKey, nowNs());
+            addChatters(1);
+        }
+    });
+    feeder.start(2);
+    waitUntil([&]() { return client.addedEvents >= total; }, (seconds + 5) * 1000);
+    feeder.stop();
+
+    std::printf("stream: %d chatters in %d batches (%.1f per batch), latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n\n",
+                client.addedEvents, client.batches, client.batches ? double(client.addedEvents) / client.batches : 0.0,
+                percentileMs(latencies, 0.5), percentileMs(latencies, 0.99), percentileMs(latencies, 1.0));
+
+    std::printf("checks:\n");
+    check(client.snapshots == 1, "new client starts from a snapshot");
+    check(client.addedEvents == total, "every added chatter arrives once");
+    check(client.seq == server.sequence(), "client seq matches the server");
+
+    // A browser source that reloads resumes from its seq without a snapshot
+    const quint64 lastSeq = client.seq;
+    client.close();
+    const quint64 before = server.sequence();
+    addChatters(25);
+    waitUntil([&server, before]() { return server.sequence() > before; }, 1000);
+
+    OverlayClient resumed;
+    resumed.open(port, QStringLiteral("?since=%1").arg(lastSeq));
+    waitUntil([&resumed, &server]() { return resumed.seq == server.sequence() && resumed.addedEvents >= 25; }, 2000);
+    check(resumed.snapshots == 0, "reconnect with since resumes without snapshot");
+    check(resumed.addedEvents == 25, "resume delivers exactly the missed chatters");
+    resumed.close();
+
+    // An unknown seq, as after a restart of OBS, falls back to a snapshot
+    OverlayClient stale;
+    stale.open(port, QStringLiteral("?since=%1").arg(server.sequence() + 1000));
+    waitUntil([&stale]() { return stale.snapshots > 0; }, 2000);
+    check(stale.snapshots == 1, "unknown since gets a snapshot");
+    check(stale.snapshotChatters == OverlayServer::SNAPSHOT_LIMIT, "snapshot holds the newest chatters only");
+    stale.close();
+
+    // Plain HTTP: the page and the snapshot
+    auto httpGet = [port](const char *path) {
+        QTcpSocket socket;
+        socket.connectToHost(QStringLiteral("127.0.0.1"), port);
+        socket.waitForConnected(2000);
+        socket.write(QByteArray("GET ") + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+        QByteArray response;
+        waitUntil([&socket, &response]() {
+            response += socket.readAll();
+            return socket.state() == QAbstractSocket::UnconnectedState;
+        }, 2000);
+        return response + socket.readAll();
+    };
+    const QByteArray page = httpGet("/");
+    check(page.startsWith("HTTP/1.1 200") && page.contains("<ul id=\"list\">"), "GET / serves the overlay page");
+    const QByteArray snapshot = httpGet("/snapshot");
+    check(snapshot.startsWith("HTTP/1.1 200") && snapshot.contains("\"type\":\"snapshot\""), "GET /snapshot serves JSON");
+    check(httpGet("/missing").startsWith("HTTP/1.1 404"), "unknown paths are 404");
+
+    std::printf("\n%s\n", failures ? "some checks FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+// Synthetic raid against the dock's default setup, where the chat connection
+// shares the UI thread: a mock Twitch server on its own thread streams chat
+// with raid bursts, and the client, IrcWorker, list model and a painted
+// QListView all run on the main thread. A 60 fps frame timer repaints the
+// list and records how long each frame took to come around, once with raid
+// handling off and once with it on. Every new chatter must still get a row.
+//
+//   raid-bench [--rate 10000] [--seconds 5] [--raid SIZE:INTERVAL_MS]
+//              [--frame-limit-ms 50]
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise.
+// Exits non-zero if, with raid handling on, the p99 frame time is over the
+// limit or a chatter went missing.
+
+#include "mock-twitch-server.hpp"
+#include "chatter-delegate.hpp"
+#include "chatter-list-model.hpp"
+#include "irc-worker.hpp"
+#include <QApplication>
+#include <QEventLoop>
+#include <QImage>
+#include <QListView>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// Same slice the dock drains its queue in during a raid, and how often it
+// looks at the clock
+static const qint64 DRAIN_SLICE_NS = 4 * 1000 * 1000;
+static const int DRAIN_CLOCK_INTERVAL = 16;
+
+static void runFor(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static bool waitFor(int timeoutMs, const std::function<bool()> &done)
+{
+    for (int waited = 0; waited < timeoutMs; waited += 10) {
+        if (done()) {
+            return true;
+        }
+        runFor(10);
+    }
+    return done();
+}
+
+static double percentileMs(std::vector<qint64> &samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<qptrdiff>(index), samples.end());
+    return samples[index] / 1e6;
+}
+
+struct PassResult {
+    bool ran = false;
+    double p50Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+    quint64 expected = 0;
+    quint64 rows = 0;
+};
+
+static PassResult runPass(MockTwitchServer *server, const MockChatProfile &profile, int seconds, bool raidHandling)
+{
+    PassResult result;
+    QTemporaryDir stateDirectory;
+    auto *worker = new IrcWorker();
+    worker->setBurstEnterRate(raidHandling ? BurstDetector::DEFAULT_ENTER_RATE : 0);
+    worker->setStateDirectory(stateDirectory.path());
+    worker->setServerUrl(server->url());
+    worker->connectToTwitch({QStringLiteral("raidtest")}, QStringLiteral("justinfan4242"), QStringLiteral("mock"));
+
+    ChatterListModel model;
+    QListView view;
+    view.setSelectionMode(QAbstractItemView::NoSelection);
+    view.setUniformItemSizes(true);
+    view.setItemDelegate(new ChatterDelegate(&view));
+    view.setModel(&model);
+    view.resize(320, 800);
+    view.show();
+
+    // Drained exactly like the dock drains it, in slices while bursting
+    bool drainScheduled = false;
+    std::function<void()> drain = [&]() {
+        worker->acknowledgeWakeup();
+        const bool sliced = worker->isBurstMode();
+        const qint64 sliceEndNs = IrcWorker::monotonicNs() + DRAIN_SLICE_NS;
+        int drained = 0;
+        FirstChatterEvent event;
+        while (worker->popFirstChatter(event)) {
+            model.enqueueChatter(event.key, event.username, event.displayName, false, event.newEver);
+            if (sliced && ++drained % DRAIN_CLOCK_INTERVAL == 0 && IrcWorker::monotonicNs() >= sliceEndNs) {
+                if (!drainScheduled) {
+                    drainScheduled = true;
+                    QTimer::singleShot(0, &model, [&]() {
+                        drainScheduled = false;
+                        drain();
+                    });
+                }
+                break;
+            }
+        }
+    };
+    QObject::connect(worker, &IrcWorker::firstChattersAvailable, &model, [&drain]() { drain(); });
+
+    quint64 rows = 0;
+    QObject::connect(&model, &QAbstractItemModel::rowsInserted, &model, [&rows](const QModelIndex &, int first, int last) {
+        rows += static_cast<quint64>(last - first + 1);
+    });
+
+    if (!waitFor(5000, [server]() { return server->hasJoinedClient(); })) {
+        std::fprintf(stderr, "Client never joined the mock server\n");
+        worker->disconnectFromTwitch();
+        delete worker;
+        return result;
+    }
+
+    // What the user sees: a repaint every 16 ms, late when the thread is busy
+    QWidget *viewport = view.viewport();
+    QImage image(viewport->size(), QImage::Format_ARGB32_Premultiplied);
+    std::vector<qint64> frames;
+    qint64 lastFrameNs = 0;
+    QTimer frameTimer;
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&frameTimer, &QTimer::timeout, [&]() {
+        const qint64 now = IrcWorker::monotonicNs();
+        if (lastFrameNs > 0) {
+            frames.push_back(now - lastFrameNs);
+        }
+        lastFrameNs = now;
+        viewport->render(&image);
+    });
+
+    const quint64 newBefore = server->newChattersSent();
+    frameTimer.start(16);
+    QMetaObject::invokeMethod(server, [server, profile]() { server->setProfile(profile); });
+    runFor(seconds * 1000);
+    QMetaObject::invokeMethod(server, [server]() { server->setProfile(MockChatProfile()); },
+                              Qt::BlockingQueuedConnection);
+
+    result.expected = server->newChattersSent() - newBefore;
+    waitFor(5000, [&]() { return rows >= result.expected; });
+    frameTimer.stop();
+
+    const BurstDetector &burst = worker->burstDetector();
+    result.ran = true;
+    result.rows = rows;
+    result.p50Ms = percentileMs(frames, 0.5);
+    result.p99Ms = percentileMs(frames, 0.99);
+    result.maxMs = percentileMs(frames, 1.0);
+    std::printf("%-8s %8zu %10.1f %10.1f %10.1f %10llu %10llu %6llu %10zu\n",
+                raidHandling ? "on" : "off", frames.size(), result.p50Ms, result.p99Ms, result.maxMs,
+                static_cast<unsigned long long>(result.expected), static_cast<unsigned long long>(result.rows),
+                static_cast<unsigned long long>(burst.burstCount()), worker->peakBacklogDepth());
+
+    worker->disconnectFromTwitch();
+    delete worker;
+    waitFor(2000, [server]() { return !server->hasJoinedClient(); });
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = 5;
+    double frameLimitMs = 50;
+    MockChatProfile profile;
+    profile.messagesPerSecond = 10000;
+    profile.raidSize = 3000;
+    profile.raidIntervalMs = 2000;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--rate") == 0 && hasValue) {
+            profile.messagesPerSecond = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--raid") == 0 && hasValue) {
+            const QStringList parts = QString::fromLocal8Bit(argv[++i]).split(QLatin1Char(':'));
+            profile.raidSize = parts.value(0).toInt();
+            profile.raidIntervalMs = parts.value(1, QStringLiteral("1000")).toInt();
+        } else if (std::strcmp(argv[i], "--frame-limit-ms") == 0 && hasValue) {
+            frameLimitMs = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    // The server gets its own thread so generating chat does not steal time
+    // from the thread under test
+    QThread serverThread;
+    auto *server = new MockTwitchServer();
+    server->moveToThread(&serverThread);
+    QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+    serverThread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(server, [server, &listening]() { listening = server->listen(); },
+                              Qt::BlockingQueuedConnection);
+    if (!listening) {
+        std::fprintf(stderr, "Mock server failed to listen\n");
+        serverThread.quit();
+        serverThread.wait();
+        return 1;
+    }
+
+    std::printf("%.0f msg/s, raid of %d every %d ms, %d s per pass, UI-thread network\n\n",
+                profile.messagesPerSecond, profile.raidSize, profile.raidIntervalMs, seconds);
+    std::printf("%-8s %8s %10s %10s %10s %10s %10s %6s %10s\n",
+                "raid", "frames", "p50 ms", "p99 ms", "max ms", "new", "rows", "raids", "backlog");
+
+    runPass(server, profile, seconds, false);
+    const PassResult adaptive = runPass(server, profile, seconds, true);
+
+    int exitCode = 0;
+    if (!adaptive.ran) {
+        exitCode = 1;
+    } else {
+        const bool bounded = adaptive.p99Ms <= frameLimitMs;
+        const bool complete = adaptive.rows >= adaptive.expected;
+        std::printf("\nwith raid handling: p99 frame %s %.0f ms, %s\n", bounded ? "within" : "OVER", frameLimitMs,
+                    complete ? "every new chatter listed" : "chatters MISSING");
+        exitCode = bounded && complete ? 0 : 1;
+    }
+
+    serverThread.quit();
+    serverThread.wait();
+    return exitCode;
+}
@@ -0,0 +1,370 @@
+#include "bot-filter.hpp"
+#include <deque>
+
+int AhoCorasick::child(int state, char16_t c) const
+{
+    auto it = m_edges.find((quint64(state) << 16) | c);
+    return it == m_edges.end() ? -1 : it->second;
+}
+
+int AhoCorasick::addChild(int state, char16_t c)
+{
+    int existing = child(state, c);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    int next = static_cast<int>(m_fail.size());
+    m_fail.push_back(0);
+    m_outputs.emplace_back();
+    m_edges.emplace((quint64(state) << 16) | c, next);
+
+    if (m_children.size() < m_fail.size()) {
+        m_children.resize(m_fail.size());
+    }
+    m_children[state].emplace_back(c, next);
+    return next;
+}
+
+void AhoCorasick::add(QStringView pattern, int id)
+{
+    int state = 0;
+    for (QChar c : pattern) {
+        state = addChild(state, c.unicode());
+    }
+    m_outputs[state].push_back(id);
+}
+
+void AhoCorasick::build()
+{
+    m_children.resize(m_fail.size());
+
+    // Breadth-first so every fail target is finished before it is inherited
+    std::deque<int> queue;
+    for (const auto &edge : m_children[0]) {
+        m_fail[edge.second] = 0;
+        queue.push_back(edge.second);
+    }
+
+    while (!queue.empty()) {
+        const int state = queue.front();
+        queue.pop_front();
+
+        for (const auto &[c, next] : m_children[state]) {
+            int fallback = m_fail[state];
+            int target = child(fallback, c);
+            while (target < 0 && fallback != 0) {
+                fallback = m_fail[fallback];
+                target = child(fallback, c);
+            }
+            m_fail[next] = target < 0 ? 0 : target;
+
+            const std::vector<int> &inherited = m_outputs[m_fail[next]];
+            m_outputs[next].insert(m_outputs[next].end(), inherited.begin(), inherited.end());
+            queue.push_back(next);
+        }
+    }
+
+    m_children.clear();
+    m_children.shrink_to_fit();
+}
+
+// Maps common look-alike characters onto one Latin letter. Letters a login
+// may contain are never folded onto each other ("l" stays "l"), or
+// ordinary names such as "lilbot" and "iiibot" would collide.
+static char16_t lookAlike(char16_t c)
+{
+    switch (c) {
+        case u'0': return u'o';
+        case u'1': case u'|': case u'!': return u'i';
+        case u'3': return u'e';
+        case u'4': case u'@': return u'a';
+        case u'5': case u'$': return u's';
+        case u'7': return u't';
+        case u'8': return u'b';
+        // Cyrillic
+        case u'а': return u'a';
+        case u'в': return u'b';
+        case u'е': case u'ё': return u'e';
+        case u'к': return u'k';
+        case u'м': return u'm';
+        case u'н': return u'h';
+        case u'о': return u'o';
+        case u'р': return u'p';
+        case u'с': return u'c';
+        case u'т': return u't';
+        case u'у': return u'y';
+        case u'х': return u'x';
+        case u'ѕ': return u's';
+        case u'і': case u'ї': return u'i';
+        case u'ј': return u'j';
+        case u'һ': return u'h';
+        case u'ԁ': return u'd';
+        // Greek
+        case u'α': return u'a';
+        case u'β': return u'b';
+        case u'ε': return u'e';
+        case u'ι': return u'i';
+        case u'κ': return u'k';
+        case u'ν': return u'v';
+        case u'ο': return u'o';
+        case u'ρ': return u'p';
+        case u'τ': return u't';
+        case u'υ': return u'u';
+        case u'χ': return u'x';
+        // Latin extensions
+        case u'ı': return u'i';
+        case u'ɡ': return u'g';
+        default: return c;
+    }
+}
+
+QString BotFilter::fold(QStringView text)
+{
+    return text.toString().normalized(QString::NormalizationForm_KC).toCaseFolded();
+}
+
+QString BotFilter::skeleton(QStringView text)
+{
+    QString result = fold(text);
+    for (QChar &c : result) {
+        c = QChar(lookAlike(c.unicode()));
+    }
+    return result;
+}
+
+bool BotFilter::globMatch(QStringView pattern, QStringView text)
+{
+    qsizetype p = 0;
+    qsizetype t = 0;
+    qsizetype starPattern = -1;
+    qsizetype starText = 0;
+
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == u'?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == u'*') {
+            starPattern = p++;
+            starText = t;
+        } else if (starPattern >= 0) {
+            // Let the last * swallow one more character and retry
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == u'*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+// Longest run of the glob without wildcards, used to prefilter it
+static QStringView longestLiteral(QStringView glob)
+{
+    QStringView best;
+    qsizetype start = 0;
+    for (qsizetype i = 0; i <= glob.size(); ++i) {
+        if (i == glob.size() || glob[i] == u'*' || glob[i] == u'?') {
+            if (i - start > best.size()) {
+                best = glob.sliced(start, i - start);
+            }
+            start = i + 1;
+        }
+    }
+    return best;
+}
+
+// Whether a regex rule still means the same inside one (?:a)|(?:b)|...
+// program. Group numbers shift and names may clash there, so anything that
+// refers to a group (backreferences, subroutine calls, conditions) or names
+// one stays separate, as do \Q quoting and extended-mode comments, which
+// could swallow the closing parenthesis.
+static bool combinable(QStringView pattern)
+{
+    for (qsizetype i = 0; i + 1 < pattern.size(); ++i) {
+        const QChar c = pattern[i];
+        const QChar next = pattern[i + 1];
+        if (c == u'\\') {
+            if ((next >= u'1' && next <= u'9') || next == u'g' || next == u'k' || next == u'Q') {
+                return false;
+            }
+            ++i;
+        } else if (c == u'(' && next == u'?') {
+            const QStringView rest = pattern.sliced(i + 2);
+            if (rest.isEmpty()) {
+                return false;
+            }
+            // (?<=...) and (?<!...) are lookbehinds; other (?< and (?' name a group
+            const bool lookbehind = rest.startsWith(u"<=") || rest.startsWith(u"<!");
+            const QChar kind = rest[0];
+            if (!lookbehind && (kind == u'(' || kind == u'R' || kind == u'&' || kind == u'P' || kind == u'<' ||
+                                kind == u'\'' || kind == u'+' || kind == u'-' || kind.isDigit())) {
+                return false;
+            }
+            // Inline options such as (?x) or (?ix:
+            for (qsizetype j = 0; j < rest.size() && rest[j].isLetter(); ++j) {
+                if (rest[j] == u'x') {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const BotFilter> BotFilter::compile(const QStringList &rules, QStringList *errors)
+{
+    std::shared_ptr<BotFilter> filter(new BotFilter());
+    QStringList regexParts;
+
+    for (const QString &line : rules) {
+        const QString rule = line.trimmed();
+        if (rule.isEmpty() || rule.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        if (rule.startsWith(QStringLiteral("badge:"), Qt::CaseInsensitive)) {
+            const QString badge = rule.mid(6).trimmed().toLower();
+            if (badge.isEmpty()) {
+                if (errors) {
+                    errors->append(QStringLiteral("%1: missing badge name").arg(rule));
+                }
+                continue;
+            }
+            filter->m_badges.insert(badge);
+        } else if (rule.startsWith(QStringLiteral("tag:"), Qt::CaseInsensitive)) {
+            const QString body = rule.mid(4);
+            const qsizetype eqIndex = body.indexOf(QLatin1Char('='));
+            if (eqIndex <= 0) {
+                if (errors) {
+                    errors->append(QStringLiteral("%1: expected tag:key=value").arg(rule));
+                }
+                continue;
+            }
+            filter->m_tagRules.push_back(TagRule{body.left(eqIndex).trimmed(), body.mid(eqIndex + 1).trimmed()});
+        } else if (rule.startsWith(QStringLiteral("re:"), Qt::CaseInsensitive) ||
+                   (rule.size() > 2 && rule.startsWith(QLatin1Char('/')) && rule.endsWith(QLatin1Char('/')))) {
+            const QString pattern = rule.startsWith(QLatin1Char('/')) ? rule.mid(1, rule.size() - 2) : rule.mid(3);
+            QRegularExpression regex(pattern, QRegularExpression::CaseInsensitiveOption);
+            if (!regex.isValid()) {
+                if (errors) {
+                    errors->append(QStringLiteral("%1: %2").arg(rule, regex.errorString()));
+                }
+                continue;
+            }
+            if (combinable(pattern)) {
+                regexParts.append(QStringLiteral("(?:") + pattern + QLatin1Char(')'));
+            } else {
+                regex.optimize();
+                filter->m_separateRegexes.push_back(regex);
+            }
+        } else if (rule.contains(QLatin1Char('*')) || rule.contains(QLatin1Char('?'))) {
+            const int id = static_cast<int>(filter->m_globs.size());
+            filter->m_globs.push_back(skeleton(rule));
+            QStringView anchor = longestLiteral(filter->m_globs.back());
+            if (anchor.isEmpty()) {
+                filter->m_unanchoredGlobs.push_back(id);
+            } else {
+                filter->m_globAnchors.add(anchor, id);
+            }
+        } else {
+            filter->m_exact.insert(skeleton(rule));
+        }
+        filter->m_ruleCount++;
+    }
+
+    filter->m_globAnchors.build();
+
+    // One PCRE2 program for all regex rules instead of one match per rule
+    if (!regexParts.isEmpty()) {
+        filter->m_regex = QRegularExpression(regexParts.join(QLatin1Char('|')),
+                                             QRegularExpression::CaseInsensitiveOption);
+        filter->m_regex.optimize();
+    }
+    filter->m_hasRegex = !regexParts.isEmpty() && filter->m_regex.isValid();
+
+    return filter;
+}
+
+bool BotFilter::matchesSkeleton(const QString &skeleton) const
+{
+    if (m_exact.contains(skeleton)) {
+        return true;
+    }
+
+    // Only globs whose literal occurs in the name need the full match
+    bool matched = m_globAnchors.scan(skeleton, [this, &skeleton](int id) {
+        return globMatch(m_globs[static_cast<size_t>(id)], skeleton);
+    });
+    if (matched) {
+        return true;
+    }
+
+    for (int id : m_unanchoredGlobs) {
+        if (globMatch(m_globs[static_cast<size_t>(id)], skeleton)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BotFilter::matchesName(const QString &login, const QString &displayName) const
+{
+    const bool distinctDisplayName = !displayName.isEmpty() &&
+                                     displayName.compare(login, Qt::CaseInsensitive) != 0;
+
+    if (matchesSkeleton(skeleton(login))) {
+        return true;
+    }
+    if (distinctDisplayName && matchesSkeleton(skeleton(displayName))) {
+        return true;
+    }
+
+    if (!m_hasRegex && m_separateRegexes.empty()) {
+        return false;
+    }
+    const QString foldedLogin = fold(login);
+    const QString foldedDisplayName = distinctDisplayName ? fold(displayName) : QString();
+    if (m_hasRegex) {
+        if (m_regex.match(foldedLogin).hasMatch()) {
+            return true;
+        }
+        if (distinctDisplayName && m_regex.match(foldedDisplayName).hasMatch()) {
+            return true;
+        }
+    }
+    for (const QRegularExpression &regex : m_separateRegexes) {
+        if (regex.match(foldedLogin).hasMatch() ||
+            (distinctDisplayName && regex.match(foldedDisplayName).hasMatch())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BotFilter::matches(const QString &login, const QString &displayName, const ChatEvent &event) const
+{
+    if (matchesName(login, displayName)) {
+        return true;
+    }
+
+    if (!event.badges.isEmpty()) {
+        for (const QString &badge : m_badges) {
+            if (event.hasBadge(badge)) {
+                return true;
+            }
+        }
+    }
+
+    for (const TagRule &rule : m_tagRules) {
+        QStringView value = event.tag(rule.key);
+        if (!value.isNull() && globMatch(rule.glob, value)) {
+            return true;
+        }
+    }
+    return false;
+}
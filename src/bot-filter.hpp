@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "chat-event.hpp"
+
+// Multi-pattern substring matcher over UTF-16 code units
+class AhoCorasick {
+public:
+    void add(QStringView pattern, int id);
+    void build();
+    bool isEmpty() const { return m_fail.size() <= 1; }
+
+    // Calls onMatch(id) for every pattern occurring in text until it returns true
+    template<typename Fn>
+    bool scan(QStringView text, Fn &&onMatch) const
+    {
+        int state = 0;
+        for (QChar c : text) {
+            int next = child(state, c.unicode());
+            while (next < 0 && state != 0) {
+                state = m_fail[state];
+                next = child(state, c.unicode());
+            }
+            state = next < 0 ? 0 : next;
+            for (int id : m_outputs[state]) {
+                if (onMatch(id)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    int child(int state, char16_t c) const;
+    int addChild(int state, char16_t c);
+
+    std::unordered_map<quint64, int> m_edges;  // (state << 16 | char) -> state
+    std::vector<std::vector<std::pair<char16_t, int>>> m_children;  // Build-time only
+    std::vector<int> m_fail = std::vector<int>(1, 0);  // State 0 is the root
+    std::vector<std::vector<int>> m_outputs = std::vector<std::vector<int>>(1);
+};
+
+// Bot rules, one per line:
+//   name              exact login or display name
+//   *_bot* / bot??    glob over login and display name
+//   /regex/ re:regex  case-insensitive regular expression
+//   badge:name        chatter wears that badge
+//   tag:key=glob      IRCv3 tag value matches the glob
+//   # comment
+// Names and globs match on a homoglyph skeleton (NFKC, case folding, and
+// common look-alikes such as Cyrillic "а" or "0" mapped to Latin letters).
+// Rules are compiled once into an exact-match set, an Aho-Corasick automaton
+// over each glob's longest literal, and one combined regular expression, so
+// matching cost does not grow with the number of name and glob rules. Regex
+// rules that refer to their own groups, e.g. by backreference, keep a
+// program of their own so their meaning does not change.
+class BotFilter {
+public:
+    static std::shared_ptr<const BotFilter> compile(const QStringList &rules, QStringList *errors = nullptr);
+
+    // login and displayName are the event's, lowercased and unescaped
+    bool matches(const QString &login, const QString &displayName, const ChatEvent &event) const;
+    bool matchesName(const QString &login, const QString &displayName) const;
+
+    int ruleCount() const { return m_ruleCount; }
+
+    // NFKC + case folding
+    static QString fold(QStringView text);
+    // fold() plus look-alike mapping
+    static QString skeleton(QStringView text);
+    static bool globMatch(QStringView pattern, QStringView text);
+
+private:
+    struct TagRule {
+        QString key;
+        QString glob;
+    };
+
+    BotFilter() = default;
+    bool matchesSkeleton(const QString &skeleton) const;
+
+    int m_ruleCount = 0;
+    QSet<QString> m_exact;
+    std::vector<QString> m_globs;
+    AhoCorasick m_globAnchors;
+    std::vector<int> m_unanchoredGlobs;  // Globs without any literal, e.g. "*"
+    QRegularExpression m_regex;  // Every combinable regex rule
+    bool m_hasRegex = false;
+    std::vector<QRegularExpression> m_separateRegexes;
+    QSet<QString> m_badges;
+    std::vector<TagRule> m_tagRules;
+};
@@ -0,0 +1,91 @@
+#include "burst-detector.hpp"
+
+static const qint64 WINDOW_NS = qint64(BurstDetector::WINDOW_MS) * 1000 * 1000;
+static const qint64 HOLD_NS = qint64(BurstDetector::HOLD_MS) * 1000 * 1000;
+
+void BurstDetector::setEnterRate(int messagesPerSecond)
+{
+    m_enterRate = qMax(0, messagesPerSecond);
+    if (m_enterRate == 0 && isBursting()) {
+        setBursting(false);
+    }
+}
+
+bool BurstDetector::countMessage(qint64 nowNs)
+{
+    bool changed = false;
+    if (nowNs - m_windowStartNs >= WINDOW_NS) {
+        changed = closeWindows(nowNs);
+    }
+    m_windowCount++;
+
+    if (isBursting()) {
+        m_burstMessages.store(m_burstMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return changed;
+    }
+
+    // Enter as soon as the window reaches the rate rather than when it ends
+    const quint32 enterCount = qMax(1u, static_cast<quint32>(qint64(m_enterRate) * WINDOW_MS / 1000));
+    if (m_enterRate > 0 && m_windowCount >= enterCount) {
+        setBursting(true);
+        return true;
+    }
+    return changed;
+}
+
+bool BurstDetector::poll(qint64 nowNs)
+{
+    if (!isBursting() || nowNs - m_windowStartNs < WINDOW_NS) {
+        return false;
+    }
+    return closeWindows(nowNs);
+}
+
+bool BurstDetector::reset()
+{
+    m_windowStartNs = 0;
+    m_windowCount = 0;
+    m_calmSinceNs = 0;
+    if (!isBursting()) {
+        return false;
+    }
+    setBursting(false);
+    return true;
+}
+
+bool BurstDetector::closeWindows(qint64 nowNs)
+{
+    // Windows after the first that saw no message at all were silent
+    const qint64 windowStartNs = m_windowStartNs;
+    const quint64 rate = nowNs - windowStartNs < 2 * WINDOW_NS ? quint64(m_windowCount) * 1000 / WINDOW_MS : 0;
+    if (rate > m_peakRate.load(std::memory_order_relaxed)) {
+        m_peakRate.store(rate, std::memory_order_relaxed);
+    }
+    m_windowStartNs = nowNs;
+    m_windowCount = 0;
+
+    if (!isBursting()) {
+        return false;
+    }
+    if (rate * 3 >= quint64(m_enterRate)) {
+        m_calmSinceNs = 0;
+        return false;
+    }
+    if (m_calmSinceNs == 0) {
+        m_calmSinceNs = windowStartNs;
+    }
+    if (nowNs - m_calmSinceNs < HOLD_NS) {
+        return false;
+    }
+    setBursting(false);
+    return true;
+}
+
+void BurstDetector::setBursting(bool bursting)
+{
+    m_calmSinceNs = 0;
+    if (bursting) {
+        m_bursts.store(m_bursts.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    m_bursting.store(bursting, std::memory_order_release);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+
+// Tells a raid from ordinary busy chat by the PRIVMSG rate. Messages are
+// counted in WINDOW_MS windows; a window at or above the enter rate starts
+// burst mode at once, and it ends after the rate stayed below a third of
+// that for HOLD_MS, so a raid that comes in waves stays one burst.
+//
+// Counting happens on the network side only; the state and counters may be
+// read from any thread.
+class BurstDetector {
+public:
+    static constexpr int WINDOW_MS = 250;
+    static constexpr int HOLD_MS = 3000;
+    // Far above a busy channel's normal rate, well below a large raid's
+    static constexpr int DEFAULT_ENTER_RATE = 1000;
+
+    // Messages per second that start burst mode; 0 never does
+    void setEnterRate(int messagesPerSecond);
+    int enterRate() const { return m_enterRate; }
+
+    // Counts one message at nowNs. Returns true when burst mode changed.
+    bool countMessage(qint64 nowNs);
+    // Ends a burst once chat went quiet; call now and then while bursting.
+    // Returns true when burst mode changed.
+    bool poll(qint64 nowNs);
+    // Ends any burst and forgets the current window, as for a new
+    // connection. Returns true when burst mode changed.
+    bool reset();
+
+    bool isBursting() const { return m_bursting.load(std::memory_order_acquire); }
+    quint64 burstCount() const { return m_bursts.load(std::memory_order_relaxed); }
+    quint64 burstMessages() const { return m_burstMessages.load(std::memory_order_relaxed); }
+    // Highest windowed rate seen, in messages per second
+    quint64 peakRate() const { return m_peakRate.load(std::memory_order_relaxed); }
+
+private:
+    bool closeWindows(qint64 nowNs);
+    void setBursting(bool bursting);
+
+    int m_enterRate = DEFAULT_ENTER_RATE;
+    qint64 m_windowStartNs = 0;
+    quint32 m_windowCount = 0;
+    qint64 m_calmSinceNs = 0;  // Start of the quiet stretch while bursting, 0 if none
+
+    // Only the counting thread writes, so plain loads and stores are enough
+    std::atomic<bool> m_bursting{false};
+    std::atomic<quint64> m_bursts{0};
+    std::atomic<quint64> m_burstMessages{0};
+    std::atomic<quint64> m_peakRate{0};
+};
@@ -0,0 +1,102 @@
+#include "chat-event.hpp"
+
+// The channel is the first parameter for every chat event
+static QStringView channelOf(const IrcMessageView &line)
+{
+    QStringView channel = line.params;
+    const qsizetype space = channel.indexOf(u' ');
+    if (space >= 0) {
+        channel.truncate(space);
+    }
+    return channel.startsWith(u'#') ? channel.sliced(1) : channel;
+}
+
+void ChatEvent::parse(Kind eventKind, const IrcMessageView &line)
+{
+    *this = ChatEvent();
+    kind = eventKind;
+    message = &line;
+    channel = channelOf(line);
+
+    // One pass over the tags instead of one IrcMessageView::tag() scan each
+    QStringView userIdTag;
+    QStringView countTag;
+    QStringView loginTag;
+    qsizetype start = 0;
+    while (start < line.tags.size()) {
+        qsizetype end = line.tags.indexOf(u';', start);
+        if (end == -1) {
+            end = line.tags.size();
+        }
+        const QStringView entry = line.tags.sliced(start, end - start);
+        start = end + 1;
+
+        const qsizetype equals = entry.indexOf(u'=');
+        const QStringView key = equals < 0 ? entry : entry.first(equals);
+        const QStringView value = equals < 0 ? QStringView() : entry.sliced(equals + 1);
+        if (key == u"display-name") {
+            displayName = value;
+        } else if (key == u"badges") {
+            badges = value;
+        } else if (key == u"user-id" || key == u"target-user-id") {
+            userIdTag = value;
+        } else if (key == u"login") {
+            loginTag = value;
+        } else if (key == u"first-msg") {
+            if (value == u"1") {
+                flags |= FirstMessage;
+            }
+        } else if (key == u"msg-id") {
+            noticeId = value;
+        } else if (key == u"msg-param-viewerCount") {
+            countTag = value;
+        }
+    }
+    userId = userIdTag.toULongLong();
+    count = countTag.toInt();
+
+    switch (kind) {
+        case Kind::Message:
+            login = line.nick();
+            text = line.trailing;
+            break;
+        case Kind::UserNotice:
+        case Kind::ClearMessage:
+            login = loginTag;
+            text = line.trailing;
+            break;
+        case Kind::ClearChat:
+            // No trailing login means the whole chat was cleared
+            login = line.trailing;
+            break;
+    }
+}
+
+void ChatEvent::parseSender(const IrcMessageView &line)
+{
+    *this = ChatEvent();
+    complete = false;
+    message = &line;
+    channel = channelOf(line);
+    login = line.nick();
+    userId = line.tag(u"user-id").toULongLong();
+}
+
+bool ChatEvent::hasBadge(QStringView name) const
+{
+    // badges=name/version,name/version
+    qsizetype start = 0;
+    while (start < badges.size()) {
+        qsizetype end = badges.indexOf(u',', start);
+        if (end < 0) {
+            end = badges.size();
+        }
+        const QStringView badge = badges.sliced(start, end - start);
+        const qsizetype slash = badge.indexOf(u'/');
+        if ((slash < 0 ? badge : badge.first(slash)) == name) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QStringView>
+#include <QtGlobal>
+#include <array>
+#include <functional>
+#include <vector>
+#include "irc-message.hpp"
+
+// One parsed chat line, as the client hands it to consumers: the kind of
+// event and the tags they use, located once per line. Text fields are views
+// into the frame being dispatched and are only valid during dispatch, so a
+// consumer copies what it keeps and nothing is copied for the others.
+struct ChatEvent {
+    enum class Kind : quint8 {
+        Message,       // PRIVMSG
+        UserNotice,    // USERNOTICE: subs, gifts, raids, announcements
+        ClearChat,     // CLEARCHAT: a ban, a timeout or the whole chat cleared
+        ClearMessage,  // CLEARMSG: one message deleted
+    };
+    static constexpr int KindCount = 4;
+
+    enum Flag : quint8 {
+        FirstMessage = 0x01,  // first-msg=1: first message ever in the channel
+    };
+
+    Kind kind = Kind::Message;
+    bool complete = true;  // False when only the sender was located, see parseSender
+    quint8 flags = 0;
+    qint32 count = 0;     // Raid viewers; 0 if none
+    quint64 userId = 0;   // user-id, or target-user-id for CLEARCHAT; 0 if absent
+    QStringView channel;  // Without '#'
+    QStringView login;    // Sender, or whom a CLEARCHAT or CLEARMSG is about; empty when chat was cleared
+    QStringView displayName;  // Raw tag value, see unescapeIrcTagValue
+    QStringView badges;       // Raw, e.g. "moderator/1,subscriber/12"
+    QStringView noticeId;     // USERNOTICE msg-id, e.g. "raid", "resub"
+    QStringView text;         // The message, a notice's attached message or the deleted message
+    const IrcMessageView *message = nullptr;  // The whole line, for other tags
+
+    // Fills the event from a parsed line of the given kind
+    void parse(Kind eventKind, const IrcMessageView &line);
+    // Channel, login and userId of a PRIVMSG only, for dedup during a raid;
+    // a subscriber that needs more calls parse() on message
+    void parseSender(const IrcMessageView &line);
+
+    bool hasFlag(Flag flag) const { return (flags & flag) != 0; }
+    bool hasBadge(QStringView name) const;
+    // Any other tag's raw value; null if the line has no such tag
+    QStringView tag(QStringView key) const { return message ? message->tag(key) : QStringView(); }
+};
+
+// Delivers chat events to whoever subscribed to their kind, in subscription
+// order, on the client's thread. Kinds without subscribers are not even
+// parsed. Not thread-safe: subscribe before the client sees traffic.
+class ChatEventDispatcher {
+public:
+    using Handler = std::function<void(const ChatEvent &event)>;
+
+    void subscribe(ChatEvent::Kind kind, Handler handler)
+    {
+        m_handlers[static_cast<size_t>(kind)].push_back(std::move(handler));
+    }
+
+    bool wants(ChatEvent::Kind kind) const { return !m_handlers[static_cast<size_t>(kind)].empty(); }
+
+    void dispatch(const ChatEvent &event) const
+    {
+        for (const Handler &handler : m_handlers[static_cast<size_t>(event.kind)]) {
+            handler(event);
+        }
+    }
+
+private:
+    std::array<std::vector<Handler>, ChatEvent::KindCount> m_handlers;
+};
@@ -0,0 +1,81 @@
+#include "chatter-delegate.hpp"
+#include "chatter-list-model.hpp"
+#include <QPainter>
+
+// Match the dark theme's former QListView::item rules
+static const int PADDING_X = 8;
+static const int PADDING_Y = 6;
+
+static const QColor NORMAL_COLOR(0xef, 0xef, 0xf1);
+static const QColor GREETED_COLOR(0x7a, 0x7a, 0x7d); // Dimmed color
+static const QColor NEW_EVER_COLOR(0xbf, 0x94, 0xff); // Accent for never-seen chatters
+static const QColor SEPARATOR_COLOR(0x2d, 0x2d, 0x32);
+static const QColor HOVER_COLOR(0x26, 0x26, 0x2c);
+
+ChatterDelegate::ChatterDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_metrics(QFont())
+    , m_normalPen(NORMAL_COLOR)
+    , m_greetedPen(GREETED_COLOR)
+    , m_newEverPen(NEW_EVER_COLOR)
+    , m_separatorPen(SEPARATOR_COLOR)
+    , m_hoverColor(HOVER_COLOR)
+{
+}
+
+void ChatterDelegate::updateFonts(const QFont &font) const
+{
+    if (m_rowHeight > 0 && font == m_font) {
+        return;
+    }
+    m_font = font;
+    m_greetedFont = font;
+    m_greetedFont.setStrikeOut(true);
+    m_metrics = QFontMetrics(font);
+    m_rowHeight = m_metrics.height() + 2 * PADDING_Y + 1;
+}
+
+void ChatterDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const auto *model = qobject_cast<const ChatterListModel *>(index.model());
+    if (!model) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    updateFonts(option.font);
+    const ChatterRecord &record = model->record(index.row());
+    const QRect rect = option.rect;
+
+    if (option.state & QStyle::State_MouseOver) {
+        painter->fillRect(rect, m_hoverColor);
+    }
+
+    painter->setPen(m_separatorPen);
+    painter->drawLine(rect.left(), rect.bottom(), rect.right(), rect.bottom());
+
+    const QRect textRect = rect.adjusted(PADDING_X, PADDING_Y, -PADDING_X, -PADDING_Y - 1);
+    const QString name = model->name(record.name);
+    const bool elide = m_metrics.horizontalAdvance(name) > textRect.width();
+
+    if (record.greeted()) {
+        painter->setFont(m_greetedFont);
+        painter->setPen(m_greetedPen);
+    } else {
+        painter->setFont(m_font);
+        painter->setPen(record.newEver() ? m_newEverPen : m_normalPen);
+    }
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine,
+                      elide ? m_metrics.elidedText(name, Qt::ElideRight, textRect.width()) : name);
+}
+
+QSize ChatterDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (!qobject_cast<const ChatterListModel *>(index.model())) {
+        return QStyledItemDelegate::sizeHint(option, index);
+    }
+
+    // Every row is one line; with uniform item sizes the view asks once
+    updateFonts(option.font);
+    return QSize(option.rect.width(), m_rowHeight);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QFontMetrics>
+#include <QPen>
+#include <QStyledItemDelegate>
+
+// Paints chatter rows straight from ChatterListModel's records: one elided
+// name per row, struck out and dimmed once greeted, accented for chatters
+// new to the channel. Fonts, metrics and pens are built once per view font
+// and shared by every row, so a row costs no QVariant, QFont or QBrush.
+//
+// Indexes from any other model are left to QStyledItemDelegate.
+class ChatterDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit ChatterDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    void updateFonts(const QFont &font) const;
+
+    // Rebuilt when the view's font changes
+    mutable QFont m_font;
+    mutable QFont m_greetedFont;
+    mutable QFontMetrics m_metrics;
+    mutable int m_rowHeight = 0;
+
+    QPen m_normalPen;
+    QPen m_greetedPen;
+    QPen m_newEverPen;
+    QPen m_separatorPen;
+    QColor m_hoverColor;
+};
@@ -0,0 +1,313 @@
+#include "chatter-event-log.hpp"
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+// Room for a few thousand events, enough for a raid between two flushes
+static const qsizetype BUFFER_BYTES = 256 * 1024;
+// A buffer this full is handed over early rather than waiting for the timer
+static const qsizetype FLUSH_THRESHOLD = BUFFER_BYTES / 2;
+static const int FLUSH_INTERVAL_MS = 1000;
+
+ChatterEventLog::ChatterEventLog(const QString &path, qint64 maxFileBytes, int keepFiles)
+    : m_path(path)
+    , m_maxFileBytes(maxFileBytes)
+    , m_keepFiles(qMax(0, keepFiles))
+    , m_thread(new QThread())
+    , m_flushTimer(new QTimer(this))
+{
+    m_front.reserve(BUFFER_BYTES);
+    m_back.reserve(BUFFER_BYTES);
+
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &ChatterEventLog::flush);
+    connect(m_thread, &QThread::started, m_flushTimer, qOverload<>(&QTimer::start));
+    // finished is emitted on the thread itself, where the timer and file live
+    connect(m_thread, &QThread::finished, this, &ChatterEventLog::threadFinished, Qt::DirectConnection);
+
+    m_thread->setObjectName(QStringLiteral("FirstTimeChatterEventLog"));
+    moveToThread(m_thread);
+    m_thread->start(QThread::LowPriority);
+}
+
+ChatterEventLog::~ChatterEventLog()
+{
+    // Deleted by its own thread after shutdownLater() or an abandoned
+    // shutdown(); the thread deletes itself
+    if (QThread::currentThread() == m_thread) {
+        return;
+    }
+    if (!m_stopped && !shutdown(1000)) {
+        return;
+    }
+    delete m_thread;
+}
+
+void ChatterEventLog::threadFinished()
+{
+    m_flushTimer->stop();
+    m_file.close();
+    QMutexLocker locker(&m_mutex);
+    m_stopped = true;
+    if (m_abandoned) {
+        deleteLater();
+        m_thread->deleteLater();
+    }
+}
+
+void ChatterEventLog::firstChat(qint64 timeMs, QStringView channel, quint64 key, QStringView login,
+                                QStringView displayName, bool newEver, QStringView message)
+{
+    QMutexLocker locker(&m_mutex);
+    beginEvent(timeMs, "first_chat", channel);
+    appendLatin1(",\"id\":\"");
+    appendNumber(key);
+    appendLatin1("\",\"login\":");
+    appendString(login);
+    appendLatin1(",\"name\":");
+    appendString(displayName);
+    appendLatin1(newEver ? ",\"new\":true" : ",\"new\":false");
+    if (!message.isEmpty()) {
+        appendLatin1(",\"message\":");
+        appendString(message);
+    }
+    endEvent();
+}
+
+void ChatterEventLog::greeted(qint64 timeMs, QStringView channel, quint64 key, QStringView displayName, bool greeted)
+{
+    QMutexLocker locker(&m_mutex);
+    beginEvent(timeMs, greeted ? "greeted" : "ungreeted", channel);
+    appendLatin1(",\"id\":\"");
+    appendNumber(key);
+    appendLatin1("\",\"name\":");
+    appendString(displayName);
+    endEvent();
+}
+
+void ChatterEventLog::raid(qint64 timeMs, QStringView channel, QStringView login, QStringView displayName,
+                           int viewers)
+{
+    QMutexLocker locker(&m_mutex);
+    beginEvent(timeMs, "raid", channel);
+    appendLatin1(",\"login\":");
+    appendString(login);
+    appendLatin1(",\"name\":");
+    appendString(displayName);
+    appendLatin1(",\"viewers\":");
+    appendNumber(static_cast<quint64>(qMax(0, viewers)));
+    endEvent();
+}
+
+void ChatterEventLog::reset(qint64 timeMs, QStringView channel, QStringView reason)
+{
+    QMutexLocker locker(&m_mutex);
+    beginEvent(timeMs, "reset", channel);
+    appendLatin1(",\"reason\":");
+    appendString(reason);
+    endEvent();
+}
+
+void ChatterEventLog::beginEvent(qint64 timeMs, const char *type, QStringView channel)
+{
+    m_eventCapacity = m_front.capacity();
+    appendLatin1("{\"ts\":");
+    appendNumber(static_cast<quint64>(qMax<qint64>(0, timeMs)));
+    appendLatin1(",\"type\":\"");
+    appendLatin1(type);
+    m_front.append('"');
+    if (!channel.isEmpty()) {
+        appendLatin1(",\"channel\":");
+        appendString(channel);
+    }
+}
+
+void ChatterEventLog::endEvent()
+{
+    appendLatin1("}\n");
+    m_events.fetch_add(1, std::memory_order_relaxed);
+    if (m_front.capacity() != m_eventCapacity) {
+        m_growths.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // One queued flush per full buffer, however many events arrive meanwhile
+    if (m_front.size() >= FLUSH_THRESHOLD && !m_flushScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &ChatterEventLog::flush, Qt::QueuedConnection);
+    }
+}
+
+void ChatterEventLog::appendLatin1(const char *text)
+{
+    m_front.append(text);
+}
+
+void ChatterEventLog::appendNumber(quint64 value)
+{
+    char digits[20];
+    int start = sizeof(digits);
+    do {
+        digits[--start] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    m_front.append(digits + start, static_cast<qsizetype>(sizeof(digits)) - start);
+}
+
+// JSON string, encoded to UTF-8 in place; unpaired surrogates become U+FFFD
+void ChatterEventLog::appendString(QStringView text)
+{
+    static const char HEX[] = "0123456789abcdef";
+    m_front.append('"');
+    const qsizetype size = text.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        char32_t c = text[i].unicode();
+        if (c < 0x80) {
+            switch (c) {
+                case '"': m_front.append("\\\""); break;
+                case '\\': m_front.append("\\\\"); break;
+                case '\n': m_front.append("\\n"); break;
+                case '\r': m_front.append("\\r"); break;
+                case '\t': m_front.append("\\t"); break;
+                default:
+                    if (c < 0x20) {
+                        const char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf]};
+                        m_front.append(escape, sizeof(escape));
+                    } else {
+                        m_front.append(static_cast<char>(c));
+                    }
+                    break;
+            }
+            continue;
+        }
+
+        if (QChar::isHighSurrogate(c) && i + 1 < size && text[i + 1].isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(static_cast<char16_t>(c), text[++i].unicode());
+        } else if (QChar::isSurrogate(c)) {
+            c = 0xfffd;
+        }
+        if (c < 0x800) {
+            const char bytes[] = {static_cast<char>(0xc0 | (c >> 6)), static_cast<char>(0x80 | (c & 0x3f))};
+            m_front.append(bytes, sizeof(bytes));
+        } else if (c < 0x10000) {
+            const char bytes[] = {static_cast<char>(0xe0 | (c >> 12)), static_cast<char>(0x80 | ((c >> 6) & 0x3f)),
+                                  static_cast<char>(0x80 | (c & 0x3f))};
+            m_front.append(bytes, sizeof(bytes));
+        } else {
+            const char bytes[] = {static_cast<char>(0xf0 | (c >> 18)), static_cast<char>(0x80 | ((c >> 12) & 0x3f)),
+                                  static_cast<char>(0x80 | ((c >> 6) & 0x3f)), static_cast<char>(0x80 | (c & 0x3f))};
+            m_front.append(bytes, sizeof(bytes));
+        }
+    }
+    m_front.append('"');
+}
+
+void ChatterEventLog::flush()
+{
+    m_flushScheduled.store(false, std::memory_order_release);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_front.isEmpty()) {
+            return;
+        }
+        // Both buffers keep their capacity, so callers never wait on the disk
+        m_front.swap(m_back);
+        m_writing = true;
+    }
+
+    if (m_file.isOpen() || openFile()) {
+        if (m_fileSize > 0 && m_fileSize + m_back.size() > m_maxFileBytes) {
+            rotate();
+        }
+        const qint64 written = m_file.isOpen() ? m_file.write(m_back) : -1;
+        if (written == m_back.size() && m_file.flush()) {
+            m_fileSize += written;
+            m_bytesWritten.fetch_add(static_cast<quint64>(written), std::memory_order_relaxed);
+            m_writeError.store(false, std::memory_order_relaxed);
+        } else {
+            // Try a fresh file with the next batch
+            m_file.close();
+            m_writeError.store(true, std::memory_order_relaxed);
+        }
+    }
+    m_back.resize(0);
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    m_writing = false;
+    m_idle.wakeAll();
+}
+
+bool ChatterEventLog::openFile()
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        m_writeError.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    m_fileSize = m_file.size();
+    return true;
+}
+
+void ChatterEventLog::rotate()
+{
+    // path.N-1 -> path.N, ..., path -> path.1; the oldest drops off
+    m_file.close();
+    if (m_keepFiles == 0) {
+        QFile::remove(m_path);
+    } else {
+        QFile::remove(QStringLiteral("%1.%2").arg(m_path).arg(m_keepFiles));
+        for (int i = m_keepFiles - 1; i >= 1; --i) {
+            QFile::rename(QStringLiteral("%1.%2").arg(m_path).arg(i), QStringLiteral("%1.%2").arg(m_path).arg(i + 1));
+        }
+        QFile::rename(m_path, m_path + QStringLiteral(".1"));
+    }
+    m_rotations.fetch_add(1, std::memory_order_relaxed);
+    openFile();
+}
+
+bool ChatterEventLog::shutdown(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+
+    // Skip the interval and write whatever is buffered now
+    QMetaObject::invokeMethod(this, &ChatterEventLog::flush, Qt::QueuedConnection);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_front.isEmpty() || m_writing) {
+            if (!m_idle.wait(&m_mutex, deadline)) {
+                break;
+            }
+        }
+    }
+
+    m_thread->quit();
+    if (!m_thread->wait(deadline)) {
+        QMutexLocker locker(&m_mutex);
+        if (!m_stopped) {
+            m_abandoned = true;
+            return false;
+        }
+        // Stopped just now; only the thread's own teardown is left
+    }
+    m_thread->wait();
+
+    // With the thread gone, anything logged after its last flush is written here
+    flush();
+    m_file.close();
+    return true;
+}
+
+void ChatterEventLog::shutdownLater()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_abandoned = true;
+    }
+    // Queued behind any pending flush; the thread stops once it has written
+    QMetaObject::invokeMethod(this, [this]() {
+        flush();
+        m_thread->quit();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringView>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+#include <atomic>
+
+// Optional record of chatter activity: one JSON object per line for each
+// first chat (with its message), greet, un-greet, incoming raid and reset, stamped with
+// wall-clock milliseconds since the epoch. For example:
+//
+//   {"ts":1700000000000,"type":"first_chat","channel":"name","id":"123","login":"x","name":"X","new":true,"message":"hi"}
+//
+// Events are encoded straight into a preallocated buffer under a short lock
+// and handed to the log's own thread in batches, once a second or when the
+// buffer fills up, so logging does no I/O and in steady state no allocation
+// on the caller's thread. The file is rotated by size: path is renamed to
+// path.1 and so on, keeping keepFiles old files.
+//
+// The log moves itself to its thread, so it takes no parent. Either delete
+// it after shutdown() returns true, or hand it over with shutdownLater().
+// When shutdown() returns false the thread is stuck in a write and the log
+// must not be touched again: it deletes itself and its thread once the
+// write returns, as after shutdownLater().
+class ChatterEventLog : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 DEFAULT_MAX_FILE_BYTES = 8 * 1024 * 1024;
+    static constexpr int DEFAULT_KEEP_FILES = 4;
+
+    explicit ChatterEventLog(const QString &path, qint64 maxFileBytes = DEFAULT_MAX_FILE_BYTES,
+                             int keepFiles = DEFAULT_KEEP_FILES);
+    ~ChatterEventLog() override;
+
+    const QString &path() const { return m_path; }
+
+    // Thread-safe; message may be empty, e.g. during a raid
+    void firstChat(qint64 timeMs, QStringView channel, quint64 key, QStringView login, QStringView displayName,
+                   bool newEver, QStringView message);
+    void greeted(qint64 timeMs, QStringView channel, quint64 key, QStringView displayName, bool greeted);
+    void raid(qint64 timeMs, QStringView channel, QStringView login, QStringView displayName, int viewers);
+    // An empty channel means every channel
+    void reset(qint64 timeMs, QStringView channel, QStringView reason);
+
+    // Writes what is buffered and stops the thread. Returns false if that
+    // took longer than timeoutMs; the rest is then abandoned along with the
+    // log, see above.
+    bool shutdown(int timeoutMs);
+    // Same without waiting: the log writes what is buffered, stops and
+    // deletes itself. Do not use it afterwards.
+    void shutdownLater();
+
+    quint64 eventCount() const { return m_events.load(std::memory_order_relaxed); }
+    quint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 flushCount() const { return m_flushes.load(std::memory_order_relaxed); }
+    quint64 rotationCount() const { return m_rotations.load(std::memory_order_relaxed); }
+    // Times the buffer had to grow because the writer fell behind
+    quint64 growthCount() const { return m_growths.load(std::memory_order_relaxed); }
+    // The file could not be opened or written; events are dropped until it can
+    bool hasWriteError() const { return m_writeError.load(std::memory_order_relaxed); }
+
+private slots:
+    void flush();
+
+private:
+    void threadFinished();
+
+    // Caller holds m_mutex
+    void beginEvent(qint64 timeMs, const char *type, QStringView channel);
+    void endEvent();
+    void appendString(QStringView text);
+    void appendNumber(quint64 value);
+    void appendLatin1(const char *text);
+
+    bool openFile();
+    void rotate();
+
+    QString m_path;
+    qint64 m_maxFileBytes;
+    int m_keepFiles;
+    QThread *m_thread;     // On the heap so a stuck one can outlive the log's owner
+    QTimer *m_flushTimer;  // Lives on m_thread
+    QFile m_file;          // Used on m_thread only
+    qint64 m_fileSize = 0;
+
+    QMutex m_mutex;
+    QWaitCondition m_idle;
+    QByteArray m_front;  // Filled by callers
+    QByteArray m_back;   // Written by the thread; swapped with m_front
+    bool m_writing = false;
+    bool m_stopped = false;    // m_thread ran its last event
+    bool m_abandoned = false;  // The thread frees everything once it stops
+    qsizetype m_eventCapacity = 0;  // m_front's capacity when the current event began
+    std::atomic<bool> m_flushScheduled{false};
+
+    std::atomic<quint64> m_events{0};
+    std::atomic<quint64> m_bytesWritten{0};
+    std::atomic<quint64> m_flushes{0};
+    std::atomic<quint64> m_rotations{0};
+    std::atomic<quint64> m_growths{0};
+    std::atomic<bool> m_writeError{false};
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QStringView>
+#include <QtGlobal>
+
+// Stable 64-bit chatter keys for on-disk indexes. Unlike qHash these do not
+// change between runs.
+namespace ChatterKey {
+
+// Keys derived from a login have the top bit set (FNV-1a over the lowercased
+// UTF-16 code units)
+inline quint64 fromLogin(QStringView login)
+{
+    quint64 hash = 14695981039346656037ull;
+    for (QChar c : login) {
+        hash ^= c.toLower().unicode();
+        hash *= 1099511628211ull;
+    }
+    return hash | (quint64(1) << 63);
+}
+
+// Prefer the immutable Twitch user-id so renamed viewers keep their key;
+// fall back to the login for lines without a user-id tag
+inline quint64 forChatter(quint64 userId, QStringView login)
+{
+    return userId != 0 ? userId : fromLogin(login);
+}
+
+// splitmix64 finalizer, spreads keys across hash table slots
+inline quint64 mix(quint64 key)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace ChatterKey
@@ -0,0 +1,243 @@
+#include "chatter-list-model.hpp"
+#include <QDateTime>
+#include <QDeadlineTimer>
+
+// One insert batch per ~60 Hz frame
+static const int FLUSH_INTERVAL_MS = 16;
+
+ChatterListModel::ChatterListModel(QObject *parent)
+    : ChatterListModel(std::make_shared<ChatterRegistry>(), parent)
+{
+}
+
+ChatterListModel::ChatterListModel(std::shared_ptr<ChatterRegistry> registry, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_registry(std::move(registry))
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &ChatterListModel::flushPending);
+}
+
+int ChatterListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(m_filter.isEmpty() ? m_rows.size() : m_visible.size());
+}
+
+QVariant ChatterListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    
+    // Fonts and colours are the delegate's business; these roles are for
+    // tooltips, accessibility and the dock
+    const ChatterRecord &row = record(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            // A copy: views may hold on to it past a reset that frees the name
+            return m_registry->view(row.name).toString();
+        case Qt::ToolTipRole: {
+            const QString text = row.newEver() ? tr("First message ever in this channel")
+                                               : tr("Returning chatter, first message today");
+            if (row.seenAtMs == 0) {
+                return text;
+            }
+            return tr("%1 at %2").arg(text, QDateTime::fromMSecsSinceEpoch(row.seenAtMs).toString(QStringLiteral("HH:mm")));
+        }
+        case UsernameRole:
+            return username(index.row());
+        case KeyRole:
+            return row.key;
+        case GreetedRole:
+            return row.greeted();
+        case NewEverRole:
+            return row.newEver();
+        default:
+            return QVariant();
+    }
+}
+
+const ChatterRow &ChatterListModel::enqueueChatter(quint64 key, const QString &username, const QString &displayName,
+                                                   bool greeted, bool newEver, qint64 seenAtMs)
+{
+    ChatterRow row;
+    row.key = key;
+    row.displayName = displayName;
+    if (displayName.compare(username, Qt::CaseInsensitive) != 0) {
+        row.login = username;
+    }
+    row.seenAtMs = seenAtMs;
+    row.greeted = greeted;
+    row.newEver = newEver;
+    m_pending.append(std::move(row));
+    if (newEver) {
+        m_newEverCount++;
+    }
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+    return m_pending.constLast();
+}
+
+ChatterRecord ChatterListModel::toRecord(ChatterRow &row, quint32 ordinal, std::vector<ChatterNameIndex::Entry> &entries)
+{
+    ChatterRecord record;
+    record.key = row.key;
+    record.seenAtMs = row.seenAtMs;
+    record.name = m_registry->intern(row.displayName);
+    entries.push_back({record.name, ordinal});
+    record.login = ChatterRecord::NoLogin;
+    if (!row.login.isEmpty()) {
+        record.login = m_registry->intern(row.login);
+        entries.push_back({record.login, ordinal});
+    }
+    record.flags = static_cast<quint8>((row.greeted ? ChatterRecord::Greeted : 0) |
+                                       (row.newEver ? ChatterRecord::NewEver : 0));
+    return record;
+}
+
+void ChatterListModel::flushPending()
+{
+    m_flushTimer->stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+    
+    const qint64 startNs = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+
+    // Insert at top (newest first)
+    const int inserted = static_cast<int>(m_pending.size());
+    const bool filtered = isFiltered();
+    std::vector<ChatterNameIndex::Entry> entries;
+    entries.reserve(static_cast<size_t>(inserted));
+    std::vector<quint32> matched;
+    
+    // While filtered, storing rows does not move the exposed ones; only the
+    // matching arrivals are inserted into the view afterwards
+    if (!filtered) {
+        beginInsertRows(QModelIndex(), 0, inserted - 1);
+    }
+    for (ChatterRow &row : m_pending) {
+        const auto ordinal = static_cast<quint32>(m_rows.size());
+        m_rows.push_front(toRecord(row, ordinal, entries));
+        if (filtered && matchesFilter(m_rows.front())) {
+            matched.push_back(ordinal);
+        }
+    }
+    m_pending.clear();
+    if (!filtered) {
+        endInsertRows();
+    }
+    m_index.insert(std::move(entries), *m_registry);
+    
+    if (!matched.empty()) {
+        beginInsertRows(QModelIndex(), 0, static_cast<int>(matched.size()) - 1);
+        m_visible.insert(m_visible.begin(), matched.rbegin(), matched.rend());
+        endInsertRows();
+    }
+    const qint64 insertNs = QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() - startNs;
+    emit countsChanged();
+    emit batchInserted(inserted, insertNs);
+}
+
+void ChatterListModel::clear()
+{
+    m_flushTimer->stop();
+    beginResetModel();
+    m_rows.clear();
+    m_pending.clear();
+    m_index.clear();
+    m_visible.clear();
+    m_newEverCount = 0;
+    endResetModel();
+    emit countsChanged();
+}
+
+void ChatterListModel::restoreRows(std::vector<ChatterRow> rows)
+{
+    m_flushTimer->stop();
+    beginResetModel();
+    m_rows.clear();
+    m_pending.clear();
+    m_index.clear();
+    m_newEverCount = 0;
+    std::vector<ChatterNameIndex::Entry> entries;
+    entries.reserve(rows.size());
+    for (ChatterRow &row : rows) {
+        if (row.newEver) {
+            m_newEverCount++;
+        }
+        m_rows.push_front(toRecord(row, static_cast<quint32>(m_rows.size()), entries));
+    }
+    m_index.insert(std::move(entries), *m_registry);
+    m_visible = isFiltered() ? m_index.match(m_filter, *m_registry) : std::vector<quint32>();
+    endResetModel();
+    emit countsChanged();
+}
+
+void ChatterListModel::setFilter(const QString &prefix)
+{
+    if (prefix == m_filter) {
+        return;
+    }
+    
+    beginResetModel();
+    m_filter = prefix;
+    m_visible = isFiltered() ? m_index.match(m_filter, *m_registry) : std::vector<quint32>();
+    endResetModel();
+}
+
+bool ChatterListModel::matchesFilter(const ChatterRecord &record) const
+{
+    return m_registry->view(record.name).startsWith(m_filter, Qt::CaseInsensitive) ||
+           (record.login != ChatterRecord::NoLogin &&
+            m_registry->view(record.login).startsWith(m_filter, Qt::CaseInsensitive));
+}
+
+size_t ChatterListModel::bytesUsed() const
+{
+    return m_rows.size() * sizeof(ChatterRecord) + m_index.bytesUsed() + m_visible.capacity() * sizeof(quint32);
+}
+
+quint64 ChatterListModel::key(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return 0;
+    }
+    return m_rows[storageIndex(row)].key;
+}
+
+QString ChatterListModel::username(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return QString();
+    }
+    const ChatterRecord &chatter = m_rows[storageIndex(row)];
+    return chatter.login == ChatterRecord::NoLogin ? m_registry->view(chatter.name).toString().toLower()
+                                                   : m_registry->view(chatter.login).toString();
+}
+
+bool ChatterListModel::isGreeted(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return false;
+    }
+    return m_rows[storageIndex(row)].greeted();
+}
+
+void ChatterListModel::setGreeted(int row, bool greeted)
+{
+    if (row < 0 || row >= rowCount()) {
+        return;
+    }
+    ChatterRecord &record = m_rows[storageIndex(row)];
+    record.flags = static_cast<quint8>(greeted ? record.flags | ChatterRecord::Greeted
+                                               : record.flags & ~ChatterRecord::Greeted);
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, {GreetedRole});
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QVector>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "chatter-name-index.hpp"
+#include "chatter-registry.hpp"
+
+// The display name is the only string most rows carry; the login is kept
+// separately only when it is not just the lowercased display name
+struct ChatterRow {
+    quint64 key = 0;
+    QString displayName;
+    QString login;
+    qint64 seenAtMs = 0;  // Wall-clock time of the first message
+    bool greeted = false;
+    bool newEver = false;
+};
+
+// What the model keeps per inserted row: fixed size and trivially copyable,
+// with the names as ChatterRegistry handles. The list delegate paints from
+// this directly instead of going through QVariant roles.
+struct ChatterRecord {
+    enum Flag : quint8 {
+        Greeted = 0x01,
+        NewEver = 0x02
+    };
+    static constexpr ChatterRegistry::Handle NoLogin = ChatterRegistry::NoHandle;
+
+    quint64 key;
+    qint64 seenAtMs;
+    ChatterRegistry::Handle name;   // Display name
+    ChatterRegistry::Handle login;  // NoLogin when the login is the lowercased display name
+    quint8 flags;
+
+    bool greeted() const { return (flags & Greeted) != 0; }
+    bool newEver() const { return (flags & NewEver) != 0; }
+};
+static_assert(std::is_trivially_copyable_v<ChatterRecord>, "ChatterRecord must stay POD");
+
+// Newest-first list of first-time chatters. Arrivals are buffered and
+// inserted with a single beginInsertRows/endInsertRows per UI tick, so a
+// raid costs a handful of model updates instead of one per chatter.
+//
+// With a filter set, only rows whose display name or login starts with it
+// are exposed, looked up in a prefix index that each insert keeps current.
+// Row numbers in the API are always the exposed ones.
+class ChatterListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        UsernameRole = Qt::UserRole,
+        KeyRole,
+        GreetedRole,
+        NewEverRole
+    };
+
+    // Without a registry the model interns names in one of its own
+    explicit ChatterListModel(QObject *parent = nullptr);
+    explicit ChatterListModel(std::shared_ptr<ChatterRegistry> registry, QObject *parent = nullptr);
+    ~ChatterListModel() override = default;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Queues a chatter for the next batched insert and returns its row
+    const ChatterRow &enqueueChatter(quint64 key, const QString &username, const QString &displayName, bool greeted,
+                                     bool newEver, qint64 seenAtMs = 0);
+    void flushPending();
+    void clear();
+
+    // Replaces the list with saved rows, given oldest first, in one reset
+    void restoreRows(std::vector<ChatterRow> rows);
+
+    // Case-insensitive name prefix; empty shows every row
+    void setFilter(const QString &prefix);
+    const QString &filter() const { return m_filter; }
+    bool isFiltered() const { return !m_filter.isEmpty(); }
+
+    // Unchecked; row must be in [0, rowCount())
+    const ChatterRecord &record(int row) const { return m_rows[storageIndex(row)]; }
+    QString name(ChatterRegistry::Handle handle) const { return m_registry->name(handle); }
+
+    quint64 key(int row) const;
+    QString username(int row) const;
+    bool isGreeted(int row) const;
+    void setGreeted(int row, bool greeted);
+
+    // Rows, search index and filter; names are counted by the registry
+    size_t bytesUsed() const;
+    const ChatterRegistry &registry() const { return *m_registry; }
+
+    int newEverCount() const { return m_newEverCount; }
+    int returningCount() const { return static_cast<int>(m_rows.size() + m_pending.size()) - m_newEverCount; }
+
+signals:
+    void countsChanged();
+    // After each batched insert; insertNs is how long storing the rows and
+    // the views' handling of the insert took
+    void batchInserted(int rows, qint64 insertNs);
+
+private:
+    ChatterRecord toRecord(ChatterRow &row, quint32 ordinal, std::vector<ChatterNameIndex::Entry> &entries);
+    bool matchesFilter(const ChatterRecord &record) const;
+
+    size_t storageIndex(int row) const
+    {
+        return m_filter.isEmpty() ? static_cast<size_t>(row)
+                                  : m_rows.size() - 1 - m_visible[static_cast<size_t>(row)];
+    }
+
+    std::deque<ChatterRecord> m_rows;  // Newest first
+    std::shared_ptr<ChatterRegistry> m_registry;
+    QVector<ChatterRow> m_pending;     // Oldest first
+    ChatterNameIndex m_index;
+    QString m_filter;
+    std::vector<quint32> m_visible;    // Ordinals of matching rows, newest first
+    QTimer *m_flushTimer;
+    int m_newEverCount = 0;
+};
@@ -0,0 +1,59 @@
+#include "chatter-name-index.hpp"
+#include <algorithm>
+#include <functional>
+
+void ChatterNameIndex::insert(std::vector<Entry> batch, const ChatterRegistry &names)
+{
+    if (batch.empty()) {
+        return;
+    }
+
+    const auto less = [&names](const Entry &a, const Entry &b) {
+        return names.view(a.name).compare(names.view(b.name), Qt::CaseInsensitive) < 0;
+    };
+    std::sort(batch.begin(), batch.end(), less);
+
+    // A restore or the first batch of a session has nothing to merge with
+    if (m_entries.empty()) {
+        m_entries = std::move(batch);
+        return;
+    }
+
+    // Where each new entry goes among the old ones; non-decreasing, since
+    // the batch is sorted
+    std::vector<size_t> positions(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        positions[i] = static_cast<size_t>(
+            std::upper_bound(m_entries.begin(), m_entries.end(), batch[i], less) - m_entries.begin());
+    }
+
+    // Fill from the back, shifting each run of old entries up by the number
+    // of new ones that still have to go in front of it
+    size_t end = m_entries.size();
+    m_entries.resize(m_entries.size() + batch.size());
+    for (size_t i = batch.size(); i-- > 0;) {
+        const size_t position = positions[i];
+        std::move_backward(m_entries.begin() + static_cast<qptrdiff>(position),
+                           m_entries.begin() + static_cast<qptrdiff>(end),
+                           m_entries.begin() + static_cast<qptrdiff>(end + i + 1));
+        m_entries[position + i] = batch[i];
+        end = position;
+    }
+}
+
+std::vector<quint32> ChatterNameIndex::match(QStringView prefix, const ChatterRegistry &names) const
+{
+    std::vector<quint32> ordinals;
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), prefix,
+                               [&names](const Entry &entry, QStringView value) {
+                                   return names.view(entry.name).compare(value, Qt::CaseInsensitive) < 0;
+                               });
+    for (; it != m_entries.end() && names.view(it->name).startsWith(prefix, Qt::CaseInsensitive); ++it) {
+        ordinals.push_back(it->ordinal);
+    }
+
+    // A chatter whose display name and login both match shows up once
+    std::sort(ordinals.begin(), ordinals.end(), std::greater<quint32>());
+    ordinals.erase(std::unique(ordinals.begin(), ordinals.end()), ordinals.end());
+    return ordinals;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QStringView>
+#include <vector>
+#include "chatter-registry.hpp"
+
+// Case-insensitive prefix index over the chatter list's display names and
+// logins: one small entry per name in a sorted array, searched with binary
+// search. Names stay in the ChatterRegistry and are compared in place, so
+// the index adds eight bytes per name.
+//
+// Batches are merged in one backward pass that moves each existing entry at
+// most once, so keeping the index current costs a few binary searches per
+// new name rather than a rescan.
+class ChatterNameIndex {
+public:
+    struct Entry {
+        ChatterRegistry::Handle name;
+        quint32 ordinal;  // Arrival order of the row, oldest 0
+    };
+
+    // Entries may be in any order
+    void insert(std::vector<Entry> batch, const ChatterRegistry &names);
+    void clear() { m_entries.clear(); }
+
+    // Ordinals of rows with a name starting with prefix, newest first and
+    // without duplicates
+    std::vector<quint32> match(QStringView prefix, const ChatterRegistry &names) const;
+
+    size_t size() const { return m_entries.size(); }
+    size_t bytesUsed() const { return m_entries.capacity() * sizeof(Entry); }
+
+private:
+    std::vector<Entry> m_entries;  // Sorted by name, case-insensitively
+};
@@ -0,0 +1,68 @@
+#include "chatter-registry.hpp"
+#include <QHashFunctions>
+#include <cstring>
+
+ChatterRegistry::Handle ChatterRegistry::intern(QStringView name)
+{
+    if (name.size() > MAX_NAME_LENGTH) {
+        name = name.left(name[MAX_NAME_LENGTH - 1].isHighSurrogate() ? MAX_NAME_LENGTH - 1 : MAX_NAME_LENGTH);
+    }
+    if ((m_spans.size() + 1) * 10 > m_slots.size() * 7) {
+        rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+    }
+
+    const size_t slot = findSlot(name, qHash(name));
+    if (m_slots[slot] != NoHandle) {
+        return m_slots[slot];
+    }
+
+    // Names never straddle chunks, so a view is always contiguous
+    const auto length = static_cast<quint32>(name.size());
+    if (m_chunks.empty() || m_used + length > CHUNK_CHARS) {
+        m_chunks.emplace_back(new char16_t[CHUNK_CHARS]);
+        m_used = 0;
+    }
+    char16_t *chars = m_chunks.back().get() + m_used;
+    std::memcpy(chars, name.utf16(), length * sizeof(char16_t));
+
+    const auto handle = static_cast<Handle>(m_spans.size());
+    m_spans.push_back({static_cast<quint32>((m_chunks.size() - 1) * CHUNK_CHARS) + m_used, length});
+    m_used += length;
+    m_slots[slot] = handle;
+    return handle;
+}
+
+void ChatterRegistry::clear()
+{
+    // Swapped rather than cleared so the tables' memory goes too
+    std::vector<std::unique_ptr<char16_t[]>>().swap(m_chunks);
+    m_used = 0;
+    std::vector<Span>().swap(m_spans);
+    std::vector<Handle>().swap(m_slots);
+}
+
+size_t ChatterRegistry::bytesUsed() const
+{
+    return m_chunks.size() * CHUNK_CHARS * sizeof(char16_t)
+        + m_spans.capacity() * sizeof(Span)
+        + m_slots.capacity() * sizeof(Handle);
+}
+
+size_t ChatterRegistry::findSlot(QStringView name, size_t hash) const
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = hash & mask;
+    while (m_slots[slot] != NoHandle && view(m_slots[slot]) != name) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void ChatterRegistry::rehash(size_t capacity)
+{
+    m_slots.assign(capacity, NoHandle);
+    for (Handle handle = 0; handle < m_spans.size(); ++handle) {
+        const QStringView name = view(handle);
+        m_slots[findSlot(name, qHash(name))] = handle;
+    }
+}
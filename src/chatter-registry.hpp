@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <memory>
+#include <vector>
+
+// Every chatter name the dock displays, interned once for the session.
+// Names are copied into an append-only arena of fixed-size UTF-16 chunks
+// and identified by small handles; a name is never moved or freed, so a
+// handle (and a view of its name) stays valid until the registry is cleared.
+// Lookups go through an open-addressing table of handles, so interning a
+// name seen before allocates nothing.
+//
+// Shared by the list models of all channels, so a name seen in several
+// costs one copy; the dock clears it with the lists on a reset, so a
+// marathon's memory does not grow with days. Not thread-safe; used from
+// the GUI thread.
+class ChatterRegistry {
+public:
+    using Handle = quint32;
+    static constexpr Handle NoHandle = 0xffffffffu;
+
+    // Longer names are cut, as in the session file, but never inside a
+    // surrogate pair
+    static constexpr int MAX_NAME_LENGTH = 255;
+
+    Handle intern(QStringView name);
+
+    // Frees every name; no handle, view or name() of one may still be held
+    void clear();
+
+    QStringView view(Handle handle) const
+    {
+        const Span &span = m_spans[handle];
+        return QStringView(m_chunks[span.offset / CHUNK_CHARS].get() + span.offset % CHUNK_CHARS,
+                           static_cast<qsizetype>(span.length));
+    }
+
+    // Shares the arena's characters instead of copying them
+    QString name(Handle handle) const
+    {
+        const QStringView chars = view(handle);
+        return QString::fromRawData(reinterpret_cast<const QChar *>(chars.utf16()), chars.size());
+    }
+
+    size_t count() const { return m_spans.size(); }
+
+    // Arena chunks, span table and lookup table as allocated
+    size_t bytesUsed() const;
+
+private:
+    static constexpr quint32 CHUNK_CHARS = 32 * 1024;
+    static constexpr size_t MIN_CAPACITY = 1024;
+
+    struct Span {
+        quint32 offset;  // Character offset across all chunks
+        quint32 length;
+    };
+
+    size_t findSlot(QStringView name, size_t hash) const;
+    void rehash(size_t capacity);
+
+    std::vector<std::unique_ptr<char16_t[]>> m_chunks;
+    quint32 m_used = 0;  // Characters used in the last chunk
+    std::vector<Span> m_spans;
+    std::vector<Handle> m_slots;  // NoHandle where empty; size is a power of two
+};
@@ -0,0 +1,27 @@
+#include "chatter-tracker.hpp"
+
+bool ChatterTracker::openLifetimeIndex(const QString &path)
+{
+    if (m_lifetimeIndex.isOpen() && m_lifetimeIndex.path() == path) {
+        return true;
+    }
+    return m_lifetimeIndex.open(path);
+}
+
+ChatterTracker::Sighting ChatterTracker::classify(quint64 key)
+{
+    // Only consulted once per chatter per session, never per message
+    return m_lifetimeIndex.insert(key) ? Sighting::NewEver : Sighting::Returning;
+}
+
+void ChatterTracker::restoreSeen(const std::vector<quint64> &keys)
+{
+    for (quint64 key : keys) {
+        m_seenChatters.insert(key);
+    }
+}
+
+void ChatterTracker::reset()
+{
+    m_seenChatters.clear();
+}
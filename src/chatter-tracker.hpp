@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QString>
+#include <vector>
+#include "flat-id-set.hpp"
+#include "lifetime-index.hpp"
+
+// Per-session first-chatter dedup and the lifetime "ever chatted here"
+// lookup. Not thread-safe: it is owned by whichever thread
+// runs the IRC client.
+class ChatterTracker {
+public:
+    enum class Sighting {
+        Returning,  // First message this session, chatted here before
+        NewEver     // First message ever in this channel
+    };
+
+    // Without an open index every first sighting counts as Returning
+    bool openLifetimeIndex(const QString &path);
+
+    // key comes from ChatterKey::forChatter(userId, username). Returns true
+    // on the first sighting this session.
+    bool markSeen(quint64 key) { return m_seenChatters.insert(key); }
+
+    // Marks chatters from a restored session as seen, without touching the
+    // lifetime index they are already in
+    void restoreSeen(const std::vector<quint64> &keys);
+
+    // Records the chatter in the lifetime index; call once per marked key
+    Sighting classify(quint64 key);
+
+    void reset();
+    size_t seenCount() const { return m_seenChatters.size(); }
+
+private:
+    FlatIdSet m_seenChatters;
+    LifetimeIndex m_lifetimeIndex;
+};
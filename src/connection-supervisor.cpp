@@ -0,0 +1,210 @@
+#include "connection-supervisor.hpp"
+#include <QDateTime>
+#include <QDeadlineTimer>
+
+static const int HEALTH_CHECK_INTERVAL_MS = 1000;
+
+// A quiet socket is pinged after this long; a PING without PONG after
+// PONG_TIMEOUT_NS marks it stalled, so a dead connection is noticed within
+// about ten seconds even in an idle channel
+static const qint64 IDLE_PING_NS = 5ll * 1000 * 1000 * 1000;
+static const qint64 PONG_TIMEOUT_NS = 5ll * 1000 * 1000 * 1000;
+
+// Busy channels are never quiet; ping them this often to keep the RTT fresh
+static const qint64 RTT_PING_INTERVAL_NS = 60ll * 1000 * 1000 * 1000;
+
+// Covers both opening the socket and getting the login accepted
+static const qint64 CONNECT_TIMEOUT_NS = 10ll * 1000 * 1000 * 1000;
+
+static const int BACKOFF_BASE_MS = 1000;
+static const int BACKOFF_MAX_MS = 60 * 1000;
+
+// Spread for server-requested reconnects, so clients do not all return at once
+static const int REQUESTED_RECONNECT_JITTER_MS = 1000;
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+ConnectionSupervisor::ConnectionSupervisor(TwitchIrcClient *client, QObject *parent)
+    : QObject(parent)
+    , m_client(client)
+    , m_healthTimer(new QTimer(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_random(QRandomGenerator::global()->generate())
+{
+    m_healthTimer->setInterval(HEALTH_CHECK_INTERVAL_MS);
+    m_reconnectTimer->setSingleShot(true);
+
+    connect(m_healthTimer, &QTimer::timeout, this, &ConnectionSupervisor::checkHealth);
+    connect(m_reconnectTimer, &QTimer::timeout, this, [this]() {
+        if (m_active) {
+            m_connectStartedNs = nowNs();
+            m_client->reconnect();
+        }
+    });
+    connect(m_client, &TwitchIrcClient::connected, this, &ConnectionSupervisor::onConnected);
+    connect(m_client, &TwitchIrcClient::welcomed, this, &ConnectionSupervisor::onWelcomed);
+    connect(m_client, &TwitchIrcClient::authenticationFailed, this, &ConnectionSupervisor::onAuthenticationFailed);
+    connect(m_client, &TwitchIrcClient::disconnected, this, &ConnectionSupervisor::onDisconnected);
+    connect(m_client, &TwitchIrcClient::connectionError, this, [this](const QString &error) {
+        m_established = false;
+        m_welcomed = false;
+        connectionLost(error, false);
+    });
+    connect(m_client, &TwitchIrcClient::pongReceived, this, &ConnectionSupervisor::onPongReceived);
+    connect(m_client, &TwitchIrcClient::reconnectRequested, this, &ConnectionSupervisor::onReconnectRequested);
+}
+
+void ConnectionSupervisor::start()
+{
+    m_active = true;
+    m_established = false;
+    m_welcomed = false;
+    m_attempt = 0;
+    m_inGap = false;
+    m_pendingPing.clear();
+    m_connectStartedNs = nowNs();
+    m_reconnectTimer->stop();
+    m_healthTimer->start();
+}
+
+void ConnectionSupervisor::stop()
+{
+    // A gap the user ended by disconnecting is not an outage
+    m_active = false;
+    m_inGap = false;
+    m_pendingPing.clear();
+    m_reconnectTimer->stop();
+    m_healthTimer->stop();
+}
+
+void ConnectionSupervisor::onConnected()
+{
+    // Twitch opens the socket even for a bad token, so the attempt count
+    // and any gap wait for the welcome
+    m_established = true;
+    m_welcomed = false;
+    m_pendingPing.clear();
+    m_lastPingNs = nowNs();
+}
+
+void ConnectionSupervisor::onWelcomed()
+{
+    const qint64 now = nowNs();
+    m_welcomed = true;
+    m_attempt = 0;
+
+    if (m_inGap) {
+        m_inGap = false;
+        emit connectionGap(m_gapStartMs, (now - m_gapStartNs) / 1000000, m_gapReason);
+    }
+}
+
+void ConnectionSupervisor::onAuthenticationFailed()
+{
+    // Retrying cannot fix the credentials; the error reaches the user instead
+    stop();
+}
+
+void ConnectionSupervisor::onDisconnected()
+{
+    // Closing the previous socket when (re)connecting also ends up here;
+    // only the loss of an established connection counts
+    if (!m_established) {
+        return;
+    }
+    m_established = false;
+    m_welcomed = false;
+    connectionLost(tr("Connection closed"), false);
+}
+
+void ConnectionSupervisor::onPongReceived(const QString &token)
+{
+    if (m_pendingPing.isEmpty() || token != m_pendingPing) {
+        return;
+    }
+    m_pendingPing.clear();
+
+    const qint64 rtt = nowNs() - m_pingSentNs;
+    m_smoothedRttNs = m_smoothedRttNs == 0 ? rtt : m_smoothedRttNs + (rtt - m_smoothedRttNs) / 8;
+    emit rttMeasured(rtt, m_smoothedRttNs);
+}
+
+void ConnectionSupervisor::onReconnectRequested()
+{
+    // Schedule first, so the disconnect this causes is not counted again
+    connectionLost(tr("Server requested reconnect"), true);
+    m_client->abortConnection();
+}
+
+void ConnectionSupervisor::checkHealth()
+{
+    if (!m_active || m_reconnectTimer->isActive()) {
+        return;
+    }
+
+    const qint64 now = nowNs();
+    switch (m_client->connectionState()) {
+        case TwitchIrcClient::ConnectionState::Connected:
+            if (!m_welcomed) {
+                if (now - m_connectStartedNs > CONNECT_TIMEOUT_NS) {
+                    connectionLost(tr("Login not accepted within %1 s").arg(CONNECT_TIMEOUT_NS / 1000000000), false);
+                    m_client->abortConnection();
+                }
+            } else if (!m_pendingPing.isEmpty()) {
+                if (now - m_pingSentNs > PONG_TIMEOUT_NS) {
+                    connectionLost(tr("No PONG within %1 s").arg(PONG_TIMEOUT_NS / 1000000000), false);
+                    m_client->abortConnection();
+                }
+            } else if (now - qMax(m_client->frameReceivedNs(), m_lastPingNs) >= IDLE_PING_NS ||
+                       now - m_lastPingNs >= RTT_PING_INTERVAL_NS) {
+                m_pendingPing = QStringLiteral("ftc-%1").arg(++m_pingSequence);
+                m_pingSentNs = now;
+                m_lastPingNs = now;
+                m_client->sendPing(m_pendingPing);
+            }
+            break;
+        case TwitchIrcClient::ConnectionState::Connecting:
+            if (now - m_connectStartedNs > CONNECT_TIMEOUT_NS) {
+                connectionLost(tr("Connect timed out"), false);
+                m_client->abortConnection();
+            }
+            break;
+        case TwitchIrcClient::ConnectionState::Disconnected:
+        case TwitchIrcClient::ConnectionState::Error:
+            // Safety net for a loss whose signal arrived while a retry was pending
+            connectionLost(tr("Connection closed"), false);
+            break;
+    }
+}
+
+void ConnectionSupervisor::connectionLost(const QString &reason, bool immediate)
+{
+    // Error and disconnect usually both fire for one loss
+    if (!m_active || m_reconnectTimer->isActive()) {
+        return;
+    }
+
+    if (!m_inGap) {
+        m_inGap = true;
+        m_gapStartNs = nowNs();
+        m_gapStartMs = QDateTime::currentMSecsSinceEpoch();
+        m_gapReason = reason;
+    }
+    m_pendingPing.clear();
+
+    const int delayMs = immediate ? static_cast<int>(m_random.bounded(REQUESTED_RECONNECT_JITTER_MS + 1))
+                                  : nextBackoffMs();
+    m_attempt++;
+    m_reconnectTimer->start(delayMs);
+    emit reconnectScheduled(m_attempt, delayMs);
+}
+
+int ConnectionSupervisor::nextBackoffMs()
+{
+    // Equal jitter: half the exponential step is fixed, half random
+    const int exponential = qMin(BACKOFF_MAX_MS, BACKOFF_BASE_MS << qMin(m_attempt, 6));
+    return exponential / 2 + static_cast<int>(m_random.bounded(exponential / 2 + 1));
+}
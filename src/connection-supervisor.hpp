@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTimer>
+#include "twitch-irc-client.hpp"
+
+// Keeps a TwitchIrcClient connected while supervision is on. It pings
+// whenever the socket has been quiet for a few seconds (and periodically
+// anyway, to track round-trip time), treats a missing PONG as a stalled
+// socket, and reconnects after any loss with jittered exponential backoff.
+// The time between losing the connection and getting it back is reported
+// as a gap, since first chatters in that window were never seen. A
+// connection only counts as back, and the backoff only restarts, once the
+// server has accepted the login; a rejected login stops supervision.
+//
+// Lives on the client's thread.
+class ConnectionSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ConnectionSupervisor(TwitchIrcClient *client, QObject *parent = nullptr);
+
+    // On when the user connects, off when they disconnect
+    void start();
+    void stop();
+    bool isActive() const { return m_active; }
+
+    // Smoothed round-trip time as in TCP (1/8 gain), 0 before the first PONG
+    qint64 smoothedRttNs() const { return m_smoothedRttNs; }
+
+signals:
+    void rttMeasured(qint64 rttNs, qint64 smoothedRttNs);
+    void reconnectScheduled(int attempt, int delayMs);
+    // Wall-clock start of a window without a connection, and its length
+    void connectionGap(qint64 startedMs, qint64 durationMs, const QString &reason);
+
+private slots:
+    void onConnected();
+    void onWelcomed();
+    void onAuthenticationFailed();
+    void onDisconnected();
+    void onPongReceived(const QString &token);
+    void onReconnectRequested();
+    void checkHealth();
+
+private:
+    void connectionLost(const QString &reason, bool immediate);
+    int nextBackoffMs();
+
+    TwitchIrcClient *m_client;
+    QTimer *m_healthTimer;
+    QTimer *m_reconnectTimer;
+    QRandomGenerator m_random;
+    bool m_active = false;
+    bool m_established = false;  // Socket open since the last start or loss
+    bool m_welcomed = false;     // Login accepted on that socket
+    int m_attempt = 0;
+    qint64 m_connectStartedNs = 0;
+
+    quint32 m_pingSequence = 0;
+    QString m_pendingPing;  // Token of the unanswered PING, if any
+    qint64 m_pingSentNs = 0;
+    qint64 m_lastPingNs = 0;
+    qint64 m_smoothedRttNs = 0;
+
+    bool m_inGap = false;
+    qint64 m_gapStartNs = 0;
+    qint64 m_gapStartMs = 0;
+    QString m_gapReason;
+};
@@ -1,9 +1,17 @@
 #include "first-time-chatter-dock.hpp"
 #include "settings-dialog.hpp"
+#include "chatter-delegate.hpp"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
-#include <QFont>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFontDatabase>
+#include <QSignalBlocker>
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <algorithm>
 
 // Default bot list
 static const QStringList DEFAULT_BOTS = {
@@ -20,28 +28,182 @@ static const QStringList DEFAULT_BOTS = {
     "phantombot"
 };
 
+// How long closing the dock may wait for settings and journal fsyncs
+static const int PERSISTENCE_SHUTDOWN_TIMEOUT_MS = 2000;
+
+// Width of the stats panel's window and interval of the OBS log summary
+static const qint64 STATS_PANEL_WINDOW_NS = 10ll * 1000 * 1000 * 1000;
+static const qint64 STATS_LOG_INTERVAL_NS = 60ll * 1000 * 1000 * 1000;
+
+// Longest the dock spends on first chatters per event-loop pass during a
+// raid; well inside one 60 fps frame
+static const qint64 DRAIN_SLICE_NS = 4 * 1000 * 1000;
+
+// How far ahead the daily reset timer is armed; rechecking hourly keeps it
+// on time across sleep and clock changes
+static const int RESET_RECHECK_MS = 60 * 60 * 1000;
+
+// How stale the saved time of the last chat message may get; idle resets
+// are measured in hours
+static const qint64 CHAT_ACTIVITY_SAVE_NS = 60ll * 1000 * 1000 * 1000;
+
+// Events drained between clock reads while slicing during a raid
+static const int DRAIN_CLOCK_INTERVAL = 16;
+
+// Per-plugin directory inside the OBS profile for state files
+static QString configDirectory()
+{
+    char *path = obs_module_config_path("");
+    QString directory = QString::fromUtf8(path);
+    bfree(path);
+    QDir().mkpath(directory);
+    return directory;
+}
+
+// Greeted state of each channel lives in its own subdirectory
+static QString channelDirectory(const QString &channel)
+{
+    QString directory = QDir(configDirectory()).filePath(QStringLiteral("channels/%1").arg(channel));
+    QDir().mkpath(directory);
+    return directory;
+}
+
+// Lowercase names without '#', duplicates and empty entries removed
+static QStringList normalizedChannels(const QStringList &channels)
+{
+    QStringList result;
+    for (const QString &channel : channels) {
+        QString name = channel.trimmed().toLower();
+        name.remove(QLatin1Char('#'));
+        if (!name.isEmpty() && !result.contains(name)) {
+            result.append(name);
+        }
+    }
+    return result;
+}
+
+// Single-channel versions kept the greeted journal in the config directory
+static void adoptLegacyGreetedState(const QString &channel)
+{
+    QDir root(configDirectory());
+    QDir target(channelDirectory(channel));
+    const QStringList files = root.entryList({QStringLiteral("greeted.snapshot"), QStringLiteral("greeted-*.journal")}, QDir::Files);
+    for (const QString &file : files) {
+        QFile::rename(root.filePath(file), target.filePath(file));
+    }
+}
+
+// Runs on the UI thread; the dock reacts once the event has been handled
+static void onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+    if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED) {
+        QMetaObject::invokeMethod(static_cast<QObject *>(data), "onStreamingStarted", Qt::QueuedConnection);
+    } else if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING || event == OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED) {
+        QMetaObject::invokeMethod(static_cast<QObject *>(data), "onSceneCollectionLoaded", Qt::QueuedConnection);
+    }
+}
+
 FirstTimeChatterDock::FirstTimeChatterDock(QWidget *parent)
     : QFrame(parent)
-    , m_ircClient(new TwitchIrcClient(this))
+    , m_ircWorker(nullptr)
+    , m_networkThread(nullptr)
+    , m_persistence(new PersistenceWriter(QStringLiteral("FirstTimeChatterDock"), QStringLiteral("OBS")))
+    , m_overlay(new OverlayServer(this))
+    , m_textOutput(new TextSourceOutput(this))
+    , m_eventLog(nullptr)
+    , m_networkStatsTimer(new QTimer(this))
+    , m_resetTimer(new QTimer(this))
+    , m_connectionState(TwitchIrcClient::ConnectionState::Disconnected)
+    , m_channelTabs(nullptr)
+    , m_searchEdit(nullptr)
+    , m_chatterList(nullptr)
+    , m_statsToggle(nullptr)
+    , m_statsLabel(nullptr)
+    , m_chatterNames(std::make_shared<ChatterRegistry>())
+    , m_threadedNetwork(false)
+    , m_captureTraffic(false)
+    , m_eventLogEnabled(false)
+    , m_statsPanelExpanded(false)
+    , m_overlayPort(0)
+    , m_textSourceLines(5)
+    , m_resetOnStreamStart(true)
+    , m_resetIdleHours(0)
+    , m_messagesAtIdleCheck(0)
+    , m_lastActivityNs(IrcWorker::monotonicNs())
+    , m_idleResetDone(false)
+    , m_lastChatActivityMs(0)
+    , m_chatActivitySavedNs(0)
+    , m_resetGeneration(0)
+    , m_peakQueueDepth(0)
+    , m_drainScheduled(false)
+    , m_queueEventCount(0)
+    , m_queueLatencyTotalNs(0)
+    , m_queueLatencyMaxNs(0)
+    , m_reconnectAttempt(0)
+    , m_loginFailed(false)
+    , m_lastRttNs(0)
+    , m_smoothedRttNs(0)
+    , m_gapCount(0)
+    , m_blindTotalMs(0)
+    , m_textUpdatesAtTick(0)
+    , m_textTickNs(0)
+    , m_textUpdateRate(0)
 {
     setupUi();
     applyDarkTheme();
     loadSettings();
-    loadGreetedState();
-    checkDailyReset();
+    applyChannels();
+    setupNetwork();
+    applyOverlaySetting();
+    applyEventLogSetting();
+    m_textOutput->setLineCount(m_textSourceLines);
+    m_textOutput->setSourceName(m_textSourceName);
     
-    connect(m_ircClient, &TwitchIrcClient::connected, this, &FirstTimeChatterDock::onIrcConnected);
-    connect(m_ircClient, &TwitchIrcClient::disconnected, this, &FirstTimeChatterDock::onIrcDisconnected);
-    connect(m_ircClient, &TwitchIrcClient::messageReceived, this, &FirstTimeChatterDock::onIrcMessage);
-    connect(m_ircClient, &TwitchIrcClient::connectionError, this, &FirstTimeChatterDock::onIrcError);
-    connect(m_ircClient, &TwitchIrcClient::connectionStateChanged, this, &FirstTimeChatterDock::onConnectionStateChanged);
+    m_resetTimer->setSingleShot(true);
+    connect(m_resetTimer, &QTimer::timeout, this, &FirstTimeChatterDock::onScheduledReset);
+    checkMissedReset();
+    scheduleReset();
+    obs_frontend_add_event_callback(onFrontendEvent, this);
 }
 
 FirstTimeChatterDock::~FirstTimeChatterDock()
 {
+    obs_frontend_remove_event_callback(onFrontendEvent, this);
     saveSettings();
     saveGreetedState();
-    m_ircClient->disconnect();
+    
+    if (m_networkThread) {
+        // The worker is deleted on its own thread once the loop finishes
+        QMetaObject::invokeMethod(m_ircWorker, "disconnectFromTwitch", Qt::BlockingQueuedConnection);
+        m_networkThread->quit();
+        m_networkThread->wait();
+    } else {
+        m_ircWorker->disconnectFromTwitch();
+    }
+    
+    if (m_eventLog) {
+        if (m_eventLog->shutdown(PERSISTENCE_SHUTDOWN_TIMEOUT_MS)) {
+            delete m_eventLog;
+        } else {
+            // Stuck on a slow disk; the log frees itself if the write ever returns
+            blog(LOG_WARNING, "[First-Time Chatter Dock] The activity log's last events may not have reached the disk");
+        }
+        m_eventLog = nullptr;
+    }
+    if (m_lastChatActivityMs > 0) {
+        m_persistence->saveSettings({{QStringLiteral("lastChatActivity"), m_lastChatActivityMs}});
+    }
+    const bool persisted = m_persistence->shutdown(PERSISTENCE_SHUTDOWN_TIMEOUT_MS);
+    for (ChannelState &state : m_channelStates) {
+        state.journal->setPersistenceWriter(nullptr);
+    }
+    if (persisted) {
+        delete m_persistence;
+    } else {
+        // Stuck on a slow disk; the writer frees itself if the write ever returns
+        blog(LOG_WARNING, "[First-Time Chatter Dock] Pending settings or greeted state may not have reached the disk");
+    }
+    m_persistence = nullptr;
 }
 
 void FirstTimeChatterDock::setupUi()
@@ -58,6 +220,10 @@ void FirstTimeChatterDock::setupUi()
     
     headerLayout->addStretch();
     
+    m_countsLabel = new QLabel(this);
+    m_countsLabel->setToolTip(tr("Never chatted here before · returning today"));
+    headerLayout->addWidget(m_countsLabel);
+    
     m_settingsButton = new QPushButton(QStringLiteral("⚙"), this);
     m_settingsButton->setFixedSize(28, 28);
     m_settingsButton->setToolTip(tr("Settings"));
@@ -65,12 +231,43 @@ void FirstTimeChatterDock::setupUi()
     
     mainLayout->addLayout(headerLayout);
     
+    // One tab per channel; hidden while only one channel is joined
+    m_channelTabs = new QTabBar(this);
+    m_channelTabs->setExpanding(false);
+    m_channelTabs->setDrawBase(false);
+    m_channelTabs->hide();
+    mainLayout->addWidget(m_channelTabs);
+    
+    // Filters the list by name prefix as you type
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Search chatters"));
+    m_searchEdit->setClearButtonEnabled(true);
+    mainLayout->addWidget(m_searchEdit);
+    
     // Chatter list
-    m_chatterList = new QListWidget(this);
+    m_chatterList = new QListView(this);
     m_chatterList->setSelectionMode(QAbstractItemView::NoSelection);
     m_chatterList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_chatterList->setUniformItemSizes(true);
+    m_chatterList->setItemDelegate(new ChatterDelegate(m_chatterList));
+    m_chatterList->viewport()->setAttribute(Qt::WA_Hover);
     mainLayout->addWidget(m_chatterList, 1);
     
+    // Collapsible pipeline statistics
+    m_statsToggle = new QToolButton(this);
+    m_statsToggle->setText(tr("Performance"));
+    m_statsToggle->setCheckable(true);
+    m_statsToggle->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+    m_statsToggle->setArrowType(Qt::RightArrow);
+    m_statsToggle->setAutoRaise(true);
+    mainLayout->addWidget(m_statsToggle);
+    
+    m_statsLabel = new QLabel(this);
+    m_statsLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_statsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_statsLabel->hide();
+    mainLayout->addWidget(m_statsLabel);
+    
     // Button row
     auto *buttonLayout = new QHBoxLayout();
     
@@ -86,7 +283,57 @@ void FirstTimeChatterDock::setupUi()
     connect(m_connectButton, &QPushButton::clicked, this, &FirstTimeChatterDock::onConnectClicked);
     connect(m_resetButton, &QPushButton::clicked, this, &FirstTimeChatterDock::onResetClicked);
     connect(m_settingsButton, &QPushButton::clicked, this, &FirstTimeChatterDock::onSettingsClicked);
-    connect(m_chatterList, &QListWidget::itemClicked, this, &FirstTimeChatterDock::onChatterClicked);
+    connect(m_chatterList, &QListView::clicked, this, &FirstTimeChatterDock::onChatterClicked);
+    connect(m_channelTabs, &QTabBar::currentChanged, this, &FirstTimeChatterDock::onChannelTabChanged);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &FirstTimeChatterDock::onSearchTextChanged);
+    connect(m_statsToggle, &QToolButton::toggled, this, &FirstTimeChatterDock::setStatsPanelExpanded);
+}
+
+void FirstTimeChatterDock::setupNetwork()
+{
+    // The thread topology is fixed for the dock's lifetime; a changed
+    // setting applies on the next OBS start
+    if (m_threadedNetwork) {
+        m_networkThread = new QThread(this);
+        m_networkThread->setObjectName(QStringLiteral("FirstTimeChatterNetwork"));
+        m_ircWorker = new IrcWorker();
+        m_ircWorker->moveToThread(m_networkThread);
+        connect(m_networkThread, &QThread::finished, m_ircWorker, &QObject::deleteLater);
+        m_networkThread->start();
+    } else {
+        m_ircWorker = new IrcWorker(this);
+    }
+    
+    connect(m_ircWorker, &IrcWorker::connected, this, &FirstTimeChatterDock::onIrcConnected);
+    connect(m_ircWorker, &IrcWorker::disconnected, this, &FirstTimeChatterDock::onIrcDisconnected);
+    connect(m_ircWorker, &IrcWorker::firstChattersAvailable, this, &FirstTimeChatterDock::onFirstChattersAvailable);
+    connect(m_ircWorker, &IrcWorker::connectionError, this, &FirstTimeChatterDock::onIrcError);
+    connect(m_ircWorker, &IrcWorker::authenticationFailed, this, &FirstTimeChatterDock::onAuthenticationFailed);
+    connect(m_ircWorker, &IrcWorker::connectionStateChanged, this, &FirstTimeChatterDock::onConnectionStateChanged);
+    connect(m_ircWorker, &IrcWorker::rttMeasured, this, &FirstTimeChatterDock::onRttMeasured);
+    connect(m_ircWorker, &IrcWorker::reconnectScheduled, this, &FirstTimeChatterDock::onReconnectScheduled);
+    connect(m_ircWorker, &IrcWorker::connectionGap, this, &FirstTimeChatterDock::onConnectionGap);
+    connect(m_ircWorker, &IrcWorker::burstModeChanged, this, &FirstTimeChatterDock::onBurstModeChanged);
+    connect(m_ircWorker, &IrcWorker::raidReceived, this, &FirstTimeChatterDock::onRaidReceived);
+    
+    QMetaObject::invokeMethod(m_ircWorker, "setStateDirectory", Q_ARG(QString, configDirectory()));
+    QMetaObject::invokeMethod(m_ircWorker, "setServerUrl", Q_ARG(QUrl, QUrl(m_serverUrl)));
+    for (const ChannelState &state : m_channelStates) {
+        seedSeenChatters(state);
+    }
+    applyBotFilter();
+    applyCaptureSetting();
+    
+    m_panelWindowStart = m_ircWorker->stats().snapshot(IrcWorker::monotonicNs());
+    m_logWindowStart = m_panelWindowStart;
+    setStatsPanelExpanded(m_statsPanelExpanded);
+    
+    connect(m_networkStatsTimer, &QTimer::timeout, this, &FirstTimeChatterDock::sampleTextOutputRate);
+    connect(m_networkStatsTimer, &QTimer::timeout, this, &FirstTimeChatterDock::updateNetworkStats);
+    connect(m_networkStatsTimer, &QTimer::timeout, this, &FirstTimeChatterDock::updatePipelineStats);
+    connect(m_networkStatsTimer, &QTimer::timeout, this, &FirstTimeChatterDock::checkIdleReset);
+    m_networkStatsTimer->start(1000);
+    updateNetworkStats();
 }
 
 void FirstTimeChatterDock::applyDarkTheme()
@@ -94,13 +341,18 @@ void FirstTimeChatterDock::applyDarkTheme()
     setStyleSheet(QStringLiteral(
         "QFrame { background-color: #18181b; }"
         "QLabel { color: #efeff1; }"
-        "QListWidget { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; }"
-        "QListWidget::item { padding: 6px 8px; border-bottom: 1px solid #2d2d32; }"
-        "QListWidget::item:hover { background-color: #26262c; }"
+        "QListView { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; }"
         "QPushButton { background-color: #9147ff; color: #ffffff; border: none; border-radius: 4px; padding: 8px 16px; }"
         "QPushButton:hover { background-color: #772ce8; }"
         "QPushButton:pressed { background-color: #5c16c5; }"
         "QPushButton:disabled { background-color: #3d3d42; color: #7a7a7d; }"
+        "QTabBar::tab { background-color: #18181b; color: #adadb8; padding: 4px 10px; border: none; border-bottom: 2px solid transparent; }"
+        "QTabBar::tab:selected { color: #efeff1; border-bottom-color: #9147ff; }"
+        "QTabBar::tab:hover { color: #efeff1; }"
+        "QLineEdit { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; padding: 4px 6px; }"
+        "QLineEdit:focus { border-color: #9147ff; }"
+        "QToolButton { color: #adadb8; border: none; }"
+        "QToolButton:checked, QToolButton:hover { color: #efeff1; }"
     ));
 }
 
@@ -108,66 +360,376 @@ void FirstTimeChatterDock::loadSettings()
 {
     QSettings settings(QStringLiteral("FirstTimeChatterDock"), QStringLiteral("OBS"));
     
-    m_channel = settings.value(QStringLiteral("channel")).toString();
+    if (settings.contains(QStringLiteral("channels"))) {
+        m_channels = normalizedChannels(settings.value(QStringLiteral("channels")).toStringList());
+    } else {
+        // Older versions monitored a single channel
+        m_channels = normalizedChannels({settings.value(QStringLiteral("channel")).toString()});
+        if (!m_channels.isEmpty()) {
+            adoptLegacyGreetedState(m_channels.first());
+        }
+    }
     m_username = settings.value(QStringLiteral("username")).toString();
     m_oauthToken = settings.value(QStringLiteral("oauthToken")).toString();
+    m_serverUrl = settings.value(QStringLiteral("serverUrl")).toString();
     
-    QStringList bots = settings.value(QStringLiteral("botList"), DEFAULT_BOTS).toStringList();
-    m_botList.clear();
-    for (const QString &bot : bots) {
-        m_botList.insert(bot.toLower());
-    }
+    m_botList = settings.value(QStringLiteral("botList"), DEFAULT_BOTS).toStringList();
     
-    m_lastResetDate = settings.value(QStringLiteral("lastResetDate"), QDate::currentDate()).toDate();
+    // Older versions reset when the calendar day changed; they keep that
+    // until the reset settings are changed
+    const bool legacyDailyReset = settings.contains(QStringLiteral("lastResetDate"));
+    m_resetOnStreamStart = settings.value(QStringLiteral("resetOnStreamStart"), true).toBool();
+    m_resetTime = QTime::fromString(settings.value(QStringLiteral("resetTime"),
+                                                   legacyDailyReset ? QStringLiteral("00:00") : QString()).toString(),
+                                    QStringLiteral("HH:mm"));
+    m_resetIdleHours = settings.value(QStringLiteral("resetIdleHours"), 0).toInt();
+    m_lastResetAt = settings.value(QStringLiteral("lastResetAt")).toDateTime();
+    if (!m_lastResetAt.isValid()) {
+        const QDate legacyDate = settings.value(QStringLiteral("lastResetDate")).toDate();
+        m_lastResetAt = legacyDate.isValid() ? legacyDate.startOfDay() : QDateTime::currentDateTime();
+    }
+    m_lastChatActivityMs = settings.value(QStringLiteral("lastChatActivity"), 0).toLongLong();
+    m_threadedNetwork = settings.value(QStringLiteral("threadedNetwork"), false).toBool();
+    m_captureTraffic = settings.value(QStringLiteral("captureTraffic"), false).toBool();
+    m_eventLogEnabled = settings.value(QStringLiteral("eventLog"), false).toBool();
+    m_statsPanelExpanded = settings.value(QStringLiteral("statsPanelExpanded"), false).toBool();
+    m_overlayPort = settings.value(QStringLiteral("overlayPort"), 0).toInt();
+    m_textSourceName = settings.value(QStringLiteral("textSourceName")).toString();
+    m_textSourceLines = settings.value(QStringLiteral("textSourceLines"), 5).toInt();
 }
 
 void FirstTimeChatterDock::saveSettings()
 {
-    QSettings settings(QStringLiteral("FirstTimeChatterDock"), QStringLiteral("OBS"));
+    // Written on the persistence thread; saves close together become one
+    QVariantHash settings;
+    settings.insert(QStringLiteral("channels"), m_channels);
+    settings.insert(QStringLiteral("channel"), QVariant());
+    settings.insert(QStringLiteral("username"), m_username);
+    settings.insert(QStringLiteral("oauthToken"), m_oauthToken);
+    settings.insert(QStringLiteral("serverUrl"), m_serverUrl);
+    settings.insert(QStringLiteral("botList"), m_botList);
+    settings.insert(QStringLiteral("lastResetDate"), QVariant());
+    settings.insert(QStringLiteral("lastResetAt"), m_lastResetAt);
+    settings.insert(QStringLiteral("resetOnStreamStart"), m_resetOnStreamStart);
+    // Stored empty when off, so a missing key still means an older version
+    settings.insert(QStringLiteral("resetTime"),
+                    m_resetTime.isValid() ? m_resetTime.toString(QStringLiteral("HH:mm")) : QStringLiteral(""));
+    settings.insert(QStringLiteral("resetIdleHours"), m_resetIdleHours);
+    settings.insert(QStringLiteral("lastChatActivity"), m_lastChatActivityMs);
+    settings.insert(QStringLiteral("threadedNetwork"), m_threadedNetwork);
+    settings.insert(QStringLiteral("captureTraffic"), m_captureTraffic);
+    settings.insert(QStringLiteral("eventLog"), m_eventLogEnabled);
+    settings.insert(QStringLiteral("statsPanelExpanded"), m_statsPanelExpanded);
+    settings.insert(QStringLiteral("overlayPort"), m_overlayPort);
+    settings.insert(QStringLiteral("textSourceName"), m_textSourceName);
+    settings.insert(QStringLiteral("textSourceLines"), m_textSourceLines);
+    m_persistence->saveSettings(settings);
+}
+
+void FirstTimeChatterDock::applyChannels()
+{
+    // Channels that stay keep their list and greeted state
+    std::vector<ChannelState> states;
+    for (const QString &name : std::as_const(m_channels)) {
+        auto it = std::find_if(m_channelStates.begin(), m_channelStates.end(),
+                               [&name](const ChannelState &state) { return state.name == name; });
+        if (it != m_channelStates.end()) {
+            states.push_back(std::move(*it));
+            m_channelStates.erase(it);
+            continue;
+        }
+        
+        ChannelState state;
+        state.name = name;
+        state.model = new ChatterListModel(m_chatterNames, this);
+        state.journal = new GreetedJournal(channelDirectory(name), this);
+        state.journal->setPersistenceWriter(m_persistence);
+        state.session = new SessionStore(channelDirectory(name), this);
+        connect(state.model, &ChatterListModel::countsChanged, this, &FirstTimeChatterDock::updateChatterCounts);
+        connect(state.model, &ChatterListModel::batchInserted, this, [this](int, qint64 insertNs) {
+            m_ircWorker->stats().record(PipelineStats::UiInsert, insertNs);
+        });
+        loadGreetedState(state);
+        restoreSession(state);
+        if (m_ircWorker) {
+            seedSeenChatters(state);
+        }
+        states.push_back(std::move(state));
+    }
+    
+    for (ChannelState &removed : m_channelStates) {
+        m_overlay->channelReset(removed.name);
+        removed.journal->sync();
+        delete removed.journal;
+        delete removed.session;
+        delete removed.model;
+    }
+    m_channelStates = std::move(states);
     
-    settings.setValue(QStringLiteral("channel"), m_channel);
-    settings.setValue(QStringLiteral("username"), m_username);
-    settings.setValue(QStringLiteral("oauthToken"), m_oauthToken);
-    settings.setValue(QStringLiteral("botList"), QStringList(m_botList.begin(), m_botList.end()));
-    settings.setValue(QStringLiteral("lastResetDate"), m_lastResetDate);
+    const QString current = m_channelTabs->currentIndex() >= 0 ? m_channelTabs->tabData(m_channelTabs->currentIndex()).toString() : QString();
+    {
+        QSignalBlocker blocker(m_channelTabs);
+        while (m_channelTabs->count() > 0) {
+            m_channelTabs->removeTab(0);
+        }
+        for (const ChannelState &state : m_channelStates) {
+            int tab = m_channelTabs->addTab(state.name);
+            m_channelTabs->setTabData(tab, state.name);
+            if (state.name == current) {
+                m_channelTabs->setCurrentIndex(tab);
+            }
+        }
+    }
+    m_channelTabs->setVisible(m_channelStates.size() > 1);
+    onChannelTabChanged(m_channelTabs->currentIndex());
 }
 
-void FirstTimeChatterDock::loadGreetedState()
+ChannelState *FirstTimeChatterDock::channelState(const QString &name)
 {
+    // A handful of channels at most; only first sightings are routed here
+    for (ChannelState &state : m_channelStates) {
+        if (state.name == name) {
+            return &state;
+        }
+    }
+    return nullptr;
+}
+
+ChannelState *FirstTimeChatterDock::currentChannelState()
+{
+    int index = m_channelTabs->currentIndex();
+    if (index < 0 || index >= static_cast<int>(m_channelStates.size())) {
+        return nullptr;
+    }
+    return &m_channelStates[index];
+}
+
+void FirstTimeChatterDock::loadGreetedState(ChannelState &state)
+{
+    state.greeted = state.journal->load();
+    
+    // Older versions kept the whole list in QSettings; move it into the first
+    // channel's journal once. Those entries are logins and are matched by
+    // login until migrated.
     QSettings settings(QStringLiteral("FirstTimeChatterDock"), QStringLiteral("OBS"));
+    if (settings.contains(QStringLiteral("greetedChatters"))) {
+        QStringList greeted = settings.value(QStringLiteral("greetedChatters")).toStringList();
+        for (const QString &chatter : greeted) {
+            QString username = chatter.toLower();
+            if (!state.greeted.legacyLogins.contains(username)) {
+                state.greeted.legacyLogins.insert(username);
+                state.journal->recordLegacyGreeted(username);
+            }
+        }
+        state.journal->sync();
+        settings.remove(QStringLiteral("greetedChatters"));
+    }
+    
+    if (state.journal->needsCompaction()) {
+        state.journal->compact(state.greeted);
+    }
+}
+
+void FirstTimeChatterDock::restoreSession(ChannelState &state)
+{
+    // The list as it was when OBS closed or crashed, greeted flags from the journal
+    std::vector<ChatterRow> rows = state.session->load();
+    for (ChatterRow &row : rows) {
+        row.greeted = isGreeted(state, row.key, row.login.isEmpty() ? row.displayName.toLower() : row.login);
+    }
     
-    QStringList greeted = settings.value(QStringLiteral("greetedChatters")).toStringList();
-    m_greetedChatters.clear();
-    for (const QString &chatter : greeted) {
-        m_greetedChatters.insert(chatter.toLower());
+    // The overlay only ever shows the newest few
+    m_overlay->channelReset(state.name);
+    const size_t shown = qMin(rows.size(), static_cast<size_t>(OverlayServer::SNAPSHOT_LIMIT));
+    for (size_t i = rows.size() - shown; i < rows.size(); ++i) {
+        m_overlay->chatterAdded(state.name, rows[i].key, rows[i].displayName, rows[i].newEver, rows[i].greeted);
+        m_textOutput->chatterAdded(rows[i].displayName);
+    }
+    state.model->restoreRows(std::move(rows));
+}
+
+void FirstTimeChatterDock::seedSeenChatters(const ChannelState &state)
+{
+    // Restored chatters are not first-time chatters again this session
+    const int count = state.model->rowCount();
+    if (count == 0) {
+        return;
+    }
+    std::vector<quint64> keys;
+    keys.reserve(static_cast<size_t>(count));
+    for (int row = 0; row < count; ++row) {
+        keys.push_back(state.model->key(row));
     }
+    IrcWorker *worker = m_ircWorker;
+    const QString channel = state.name;
+    QMetaObject::invokeMethod(m_ircWorker, [worker, channel, keys]() {
+        worker->seedSeen(channel, keys);
+    });
 }
 
 void FirstTimeChatterDock::saveGreetedState()
 {
-    QSettings settings(QStringLiteral("FirstTimeChatterDock"), QStringLiteral("OBS"));
-    settings.setValue(QStringLiteral("greetedChatters"), QStringList(m_greetedChatters.begin(), m_greetedChatters.end()));
+    // Toggles are journaled as they happen; this only forces them to disk
+    for (ChannelState &state : m_channelStates) {
+        state.journal->sync();
+    }
 }
 
-void FirstTimeChatterDock::checkDailyReset()
+void FirstTimeChatterDock::clearGreetedState()
 {
-    QDate today = QDate::currentDate();
-    if (m_lastResetDate != today) {
-        // New day - reset everything
-        m_seenChatters.clear();
-        m_greetedChatters.clear();
-        m_chatterList->clear();
-        m_lastResetDate = today;
-        saveSettings();
-        saveGreetedState();
+    for (ChannelState &state : m_channelStates) {
+        state.greeted.clear();
+        state.journal->recordClear();
+        state.journal->compact(state.greeted);
+    }
+}
+
+void FirstTimeChatterDock::clearChatterLists()
+{
+    for (ChannelState &state : m_channelStates) {
+        state.model->clear();
+        state.session->clear();
+    }
+    // No row refers to a name any more
+    m_chatterNames->clear();
+    m_overlay->channelReset();
+    m_textOutput->clear();
+}
+
+void FirstTimeChatterDock::resetAll(const QString &reason)
+{
+    resetSeenChatters();
+    clearGreetedState();
+    clearChatterLists();
+    m_lastResetAt = QDateTime::currentDateTime();
+    m_lastResetReason = reason;
+    saveSettings();
+    if (m_eventLog) {
+        m_eventLog->reset(m_lastResetAt.toMSecsSinceEpoch(), QStringView(), reason);
+    }
+    blog(LOG_INFO, "[First-Time Chatter Dock] Chatters reset: %s", reason.toUtf8().constData());
+}
+
+void FirstTimeChatterDock::scheduleReset()
+{
+    m_resetTimer->stop();
+    m_nextScheduledReset = QDateTime();
+    if (!m_resetTime.isValid()) {
+        return;
+    }
+    
+    const QDateTime now = QDateTime::currentDateTime();
+    QDateTime next(now.date(), m_resetTime);
+    if (next <= now) {
+        next = QDateTime(now.date().addDays(1), m_resetTime);
+    }
+    if (!next.isValid()) {
+        // The time falls into a daylight saving gap today; look again later
+        m_resetTimer->start(RESET_RECHECK_MS);
+        return;
+    }
+    m_nextScheduledReset = next;
+    m_resetTimer->start(static_cast<int>(qBound<qint64>(0, now.msecsTo(next), RESET_RECHECK_MS)));
+}
+
+void FirstTimeChatterDock::onScheduledReset()
+{
+    if (m_nextScheduledReset.isValid() && QDateTime::currentDateTime() >= m_nextScheduledReset) {
+        resetAll(tr("daily reset at %1").arg(m_resetTime.toString(QStringLiteral("HH:mm"))));
+    }
+    scheduleReset();
+}
+
+void FirstTimeChatterDock::onStreamingStarted()
+{
+    if (m_resetOnStreamStart) {
+        resetAll(tr("stream started"));
+    }
+}
+
+void FirstTimeChatterDock::onSceneCollectionLoaded()
+{
+    // The text source may only exist now
+    m_textOutput->refresh();
+}
+
+void FirstTimeChatterDock::checkMissedReset()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    
+    // A daily reset time that passed while OBS was closed
+    if (m_resetTime.isValid()) {
+        QDateTime last(now.date(), m_resetTime);
+        if (last > now) {
+            last = QDateTime(now.date().addDays(-1), m_resetTime);
+        }
+        if (last.isValid() && m_lastResetAt < last) {
+            resetAll(tr("missed daily reset at %1").arg(m_resetTime.toString(QStringLiteral("HH:mm"))));
+            return;
+        }
+    }
+    
+    // Chat that had been quiet long enough when OBS closed, measured from
+    // the last message of any kind, as at runtime. The newest first chatter
+    // is no guide: a long stream's regulars may all have arrived early.
+    if (m_resetIdleHours > 0 && m_lastChatActivityMs > 0 &&
+        now.toMSecsSinceEpoch() - m_lastChatActivityMs >= m_resetIdleHours * 3600000ll) {
+        resetAll(tr("%1 hours without chat").arg(m_resetIdleHours));
     }
 }
 
+void FirstTimeChatterDock::checkIdleReset()
+{
+    // Tracked with idle resets off too, so turning them on or restarting
+    // knows when chat was last active
+    const qint64 nowNs = IrcWorker::monotonicNs();
+    const quint64 messages = m_ircWorker->stats().messageCount();
+    if (messages != m_messagesAtIdleCheck) {
+        m_messagesAtIdleCheck = messages;
+        m_lastActivityNs = nowNs;
+        m_idleResetDone = false;
+        m_lastChatActivityMs = QDateTime::currentMSecsSinceEpoch();
+        if (m_chatActivitySavedNs == 0 || nowNs - m_chatActivitySavedNs >= CHAT_ACTIVITY_SAVE_NS) {
+            m_chatActivitySavedNs = nowNs;
+            m_persistence->saveSettings({{QStringLiteral("lastChatActivity"), m_lastChatActivityMs}});
+        }
+        return;
+    }
+    if (m_resetIdleHours <= 0) {
+        return;
+    }
+    if (!m_idleResetDone && nowNs - m_lastActivityNs >= m_resetIdleHours * 3600ll * 1000 * 1000 * 1000) {
+        m_idleResetDone = true;
+        resetAll(tr("%1 hours without chat").arg(m_resetIdleHours));
+    }
+}
+
+void FirstTimeChatterDock::resetSeenChatters()
+{
+    ++m_resetGeneration;
+    QMetaObject::invokeMethod(m_ircWorker, "resetSeen", Q_ARG(quint32, m_resetGeneration));
+}
+
 void FirstTimeChatterDock::updateStatusIndicator()
 {
-    switch (m_ircClient->connectionState()) {
+    // Between a lost connection and the supervisor's next attempt
+    if (m_reconnectAttempt > 0 && m_connectionState != TwitchIrcClient::ConnectionState::Connected) {
+        m_statusLabel->setText(tr("🟡 Reconnecting (attempt %1)").arg(m_reconnectAttempt));
+        m_connectButton->setText(tr("Cancel"));
+        return;
+    }
+    
+    // The supervisor gave up; the user has to fix the token or account
+    if (m_loginFailed && m_connectionState != TwitchIrcClient::ConnectionState::Connected) {
+        m_statusLabel->setText(tr("🔴 Login failed"));
+        m_connectButton->setText(tr("Connect"));
+        return;
+    }
+    
+    switch (m_connectionState) {
         case TwitchIrcClient::ConnectionState::Connected:
-            m_statusLabel->setText(QStringLiteral("🟢 Connected"));
+            m_statusLabel->setText(m_ircWorker && m_ircWorker->isBurstMode() ? tr("🟢 Connected · 🌊 Raid")
+                                                                             : QStringLiteral("🟢 Connected"));
             m_connectButton->setText(tr("Disconnect"));
             break;
         case TwitchIrcClient::ConnectionState::Connecting:
@@ -186,103 +748,489 @@ void FirstTimeChatterDock::updateStatusIndicator()
     }
 }
 
-void FirstTimeChatterDock::addChatterToList(const QString &displayName, const QString &username)
+void FirstTimeChatterDock::updateChatterCounts()
 {
-    auto *item = new QListWidgetItem(displayName);
-    item->setData(Qt::UserRole, username);
+    ChannelState *current = currentChannelState();
+    QString counts = tr("✨ %1 new · %2 returning")
+        .arg(current ? current->model->newEverCount() : 0)
+        .arg(current ? current->model->returningCount() : 0);
+    if (current && current->model->isFiltered()) {
+        counts += tr(" · %1 found").arg(current->model->rowCount());
+    }
+    m_countsLabel->setText(counts);
     
-    // Check if already greeted
-    if (m_greetedChatters.contains(username)) {
-        QFont font = item->font();
-        font.setStrikeOut(true);
-        item->setFont(font);
-        item->setForeground(QColor(0x7a, 0x7a, 0x7d)); // Dimmed color
-    } else {
-        item->setForeground(QColor(0xef, 0xef, 0xf1)); // Normal color
+    for (int tab = 0; tab < m_channelTabs->count(); ++tab) {
+        const ChatterListModel *model = m_channelStates[tab].model;
+        m_channelTabs->setTabText(tab, QStringLiteral("%1 (%2)")
+            .arg(m_channelStates[tab].name)
+            .arg(model->newEverCount() + model->returningCount()));
+    }
+}
+
+bool FirstTimeChatterDock::isGreeted(ChannelState &state, quint64 key, const QString &username)
+{
+    if (state.greeted.keys.contains(key)) {
+        return true;
+    }
+    
+    // Migrate a login-based entry to the chatter's key the first time we see them
+    if (!state.greeted.legacyLogins.isEmpty() && state.greeted.legacyLogins.remove(username)) {
+        state.greeted.keys.insert(key);
+        state.journal->recordGreeted(key);
+        state.journal->recordLegacyForgotten(username);
+        return true;
+    }
+    return false;
+}
+
+void FirstTimeChatterDock::addChatterToList(const FirstChatterEvent &event, qint64 seenAtMs)
+{
+    ChannelState *state = channelState(event.channel);
+    if (!state) {
+        // Channel was removed while its events were in flight
+        return;
+    }
+    
+    // Rows are inserted in one batch on the next UI tick
+    const ChatterRow &row = state->model->enqueueChatter(event.key, event.username, event.displayName,
+                                                         isGreeted(*state, event.key, event.username), event.newEver,
+                                                         seenAtMs);
+    const qint64 persistStartNs = IrcWorker::monotonicNs();
+    state->session->append(row);
+    m_ircWorker->stats().record(PipelineStats::Persist, IrcWorker::monotonicNs() - persistStartNs);
+    m_overlay->chatterAdded(state->name, event.key, event.displayName, event.newEver, row.greeted);
+    m_textOutput->chatterAdded(event.displayName);
+    if (m_eventLog) {
+        m_eventLog->firstChat(seenAtMs, state->name, event.key, event.username, event.displayName, event.newEver,
+                              event.message);
+    }
+}
+
+void FirstTimeChatterDock::updateNetworkStats()
+{
+    qint64 averageNs = m_queueEventCount ? m_queueLatencyTotalNs / qint64(m_queueEventCount) : 0;
+    
+    m_statusLabel->setToolTip(tr("Network: %1\n"
+                                 "Queue depth: %2 / %3 (peak %4, spilled %5)\n"
+                                 "Cross-thread latency: avg %6 µs, max %7 µs\n"
+                                 "Disk writes: %8 (coalesced %9)")
+        .arg(m_threadedNetwork ? tr("dedicated thread") : tr("UI thread"))
+        .arg(m_ircWorker->queueDepth())
+        .arg(m_ircWorker->queueCapacity())
+        .arg(m_peakQueueDepth)
+        .arg(m_ircWorker->overflowCount())
+        .arg(averageNs / 1000)
+        .arg(m_queueLatencyMaxNs / 1000)
+        .arg(m_persistence->writeCount())
+        .arg(m_persistence->coalescedCount())
+        + memorySummary()
+        + overlaySummary()
+        + textOutputSummary()
+        + connectionSummary()
+        + burstSummary()
+        + resetSummary()
+        + eventLogSummary()
+        + commandSummary());
+}
+
+void FirstTimeChatterDock::updatePipelineStats()
+{
+    const PipelineStats::Snapshot now = m_ircWorker->stats().snapshot(IrcWorker::monotonicNs());
+    
+    if (now.takenNs - m_logWindowStart.takenNs >= STATS_LOG_INTERVAL_NS) {
+        if (now.messages != m_logWindowStart.messages) {
+            const QString summary = PipelineStats::summary(m_logWindowStart, now);
+            for (const QString &line : summary.split(QLatin1Char('\n'))) {
+                blog(LOG_INFO, "[First-Time Chatter Dock] %s", line.toUtf8().constData());
+            }
+        }
+        m_logWindowStart = now;
     }
     
-    // Insert at top (newest first)
-    m_chatterList->insertItem(0, item);
+    if (m_statsPanelExpanded) {
+        m_statsLabel->setText(PipelineStats::summary(m_panelWindowStart, now));
+    }
+    if (now.takenNs - m_panelWindowStart.takenNs >= STATS_PANEL_WINDOW_NS) {
+        m_panelWindowStart = now;
+    }
+}
+
+void FirstTimeChatterDock::setStatsPanelExpanded(bool expanded)
+{
+    m_statsPanelExpanded = expanded;
+    {
+        QSignalBlocker blocker(m_statsToggle);
+        m_statsToggle->setChecked(expanded);
+    }
+    m_statsToggle->setArrowType(expanded ? Qt::DownArrow : Qt::RightArrow);
+    m_statsLabel->setVisible(expanded);
+    if (expanded) {
+        m_statsLabel->setText(PipelineStats::summary(m_panelWindowStart,
+            m_ircWorker->stats().snapshot(IrcWorker::monotonicNs())));
+    }
+}
+
+QString FirstTimeChatterDock::connectionSummary() const
+{
+    QString summary;
+    if (m_smoothedRttNs > 0) {
+        summary += QLatin1Char('\n') + tr("Ping RTT: %1 ms (smoothed %2 ms)")
+            .arg(QString::number(m_lastRttNs / 1e6, 'f', 1))
+            .arg(QString::number(m_smoothedRttNs / 1e6, 'f', 1));
+    }
+    if (m_gapCount > 0) {
+        summary += QLatin1Char('\n') + tr("Blind for %1 s in %2 outages; last %3")
+            .arg(QString::number(m_blindTotalMs / 1000.0, 'f', 1))
+            .arg(m_gapCount)
+            .arg(m_lastGap);
+    }
+    return summary;
+}
+
+QString FirstTimeChatterDock::burstSummary() const
+{
+    const BurstDetector &burst = m_ircWorker->burstDetector();
+    QString summary;
+    if (burst.burstCount() > 0) {
+        summary = QLatin1Char('\n') + tr("Raid mode: %1, %2 raids, %3 messages with reduced work, peak %4 msg/s, frame backlog peak %5 (%6 shed)")
+            .arg(burst.isBursting() ? tr("on") : tr("off"))
+            .arg(burst.burstCount())
+            .arg(burst.burstMessages())
+            .arg(burst.peakRate())
+            .arg(m_ircWorker->peakBacklogDepth())
+            .arg(m_ircWorker->shedFrameCount());
+    }
+    if (!m_lastRaid.isEmpty()) {
+        summary += QLatin1Char('\n') + tr("Last raid: %1").arg(m_lastRaid);
+    }
+    return summary;
 }
 
-bool FirstTimeChatterDock::isBot(const QString &username) const
+QString FirstTimeChatterDock::resetSummary() const
 {
-    return m_botList.contains(username.toLower());
+    QString summary = QLatin1Char('\n') + tr("Last reset: %1")
+        .arg(m_lastResetAt.toString(QStringLiteral("yyyy-MM-dd HH:mm")));
+    if (!m_lastResetReason.isEmpty()) {
+        summary += QStringLiteral(" (%1)").arg(m_lastResetReason);
+    }
+    if (m_nextScheduledReset.isValid()) {
+        summary += tr(", next %1").arg(m_nextScheduledReset.toString(QStringLiteral("yyyy-MM-dd HH:mm")));
+    }
+    return summary;
+}
+
+QString FirstTimeChatterDock::eventLogSummary() const
+{
+    if (!m_eventLog) {
+        return QString();
+    }
+    return QLatin1Char('\n') + tr("Event log: %1 events, %2 KiB in %3 flushes, %4 rotations%5")
+        .arg(m_eventLog->eventCount())
+        .arg(m_eventLog->bytesWritten() / 1024)
+        .arg(m_eventLog->flushCount())
+        .arg(m_eventLog->rotationCount())
+        .arg(m_eventLog->hasWriteError() ? tr(", cannot write") : QString());
+}
+
+QString FirstTimeChatterDock::memorySummary() const
+{
+    // Names are interned once across channels; rows and search entries are
+    // per channel
+    size_t bytes = m_chatterNames->bytesUsed();
+    size_t rows = 0;
+    for (const ChannelState &state : m_channelStates) {
+        bytes += state.model->bytesUsed();
+        rows += static_cast<size_t>(state.model->newEverCount() + state.model->returningCount());
+    }
+    if (rows == 0) {
+        return QString();
+    }
+    return QLatin1Char('\n') + tr("Chatter list: %1 names, %2 KiB, %3 bytes per chatter")
+        .arg(m_chatterNames->count())
+        .arg(bytes / 1024)
+        .arg(bytes / rows);
+}
+
+QString FirstTimeChatterDock::overlaySummary() const
+{
+    if (!m_overlay->isListening()) {
+        return QString();
+    }
+    return QLatin1Char('\n') + tr("Overlay: http://127.0.0.1:%1/ (%2 sources, batch %3, %4 resumed, %5 snapshots)")
+        .arg(m_overlay->port())
+        .arg(m_overlay->clientCount())
+        .arg(m_overlay->sequence())
+        .arg(m_overlay->resumeCount())
+        .arg(m_overlay->snapshotCount());
+}
+
+void FirstTimeChatterDock::sampleTextOutputRate()
+{
+    // Once per stats tick; the tooltip is also rebuilt between ticks
+    const qint64 now = IrcWorker::monotonicNs();
+    const quint64 updates = m_textOutput->updateCount();
+    if (m_textTickNs > 0 && now > m_textTickNs) {
+        m_textUpdateRate = (updates - m_textUpdatesAtTick) * 1e9 / double(now - m_textTickNs);
+    }
+    m_textUpdatesAtTick = updates;
+    m_textTickNs = now;
+}
+
+QString FirstTimeChatterDock::textOutputSummary() const
+{
+    if (m_textOutput->sourceName().isEmpty()) {
+        return QString();
+    }
+    const quint64 requests = m_textOutput->requestCount();
+    return QLatin1Char('\n') + tr("Text source \"%1\": %2 updates/s (%3 updates for %4 changes, %5 unchanged)")
+        .arg(m_textOutput->sourceName())
+        .arg(QString::number(m_textUpdateRate, 'f', 1))
+        .arg(m_textOutput->updateCount())
+        .arg(requests)
+        .arg(m_textOutput->unchangedCount());
+}
+
+QString FirstTimeChatterDock::commandSummary() const
+{
+    // Busiest commands first, so it is obvious what the channel mostly sends
+    std::vector<std::pair<quint64, IrcCommand>> counts;
+    for (int i = 0; i < IrcCommandCount; ++i) {
+        const auto command = static_cast<IrcCommand>(i);
+        const quint64 count = m_ircWorker->commandCount(command);
+        if (count > 0) {
+            counts.emplace_back(count, command);
+        }
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    QString summary;
+    for (const auto &[count, command] : counts) {
+        summary += QStringLiteral("\n  %1: %2").arg(QLatin1String(ircCommandName(command))).arg(count);
+    }
+    return summary.isEmpty() ? QString() : QLatin1Char('\n') + tr("Lines by command:") + summary;
 }
 
 void FirstTimeChatterDock::onConnectClicked()
 {
-    if (m_ircClient->connectionState() == TwitchIrcClient::ConnectionState::Connected ||
-        m_ircClient->connectionState() == TwitchIrcClient::ConnectionState::Connecting) {
-        m_ircClient->disconnect();
+    if (m_connectionState == TwitchIrcClient::ConnectionState::Connected ||
+        m_connectionState == TwitchIrcClient::ConnectionState::Connecting ||
+        m_reconnectAttempt > 0) {
+        m_reconnectAttempt = 0;
+        QMetaObject::invokeMethod(m_ircWorker, "disconnectFromTwitch");
+        updateStatusIndicator();
     } else {
-        // Check daily reset before connecting
-        checkDailyReset();
-        
-        if (m_channel.isEmpty() || m_username.isEmpty() || m_oauthToken.isEmpty()) {
+        if (m_channels.isEmpty() || m_username.isEmpty() || m_oauthToken.isEmpty()) {
             QMessageBox::warning(this, tr("Configuration Required"),
-                tr("Please configure your Twitch channel, username, and OAuth token in settings."));
+                tr("Please configure your Twitch channels, username, and OAuth token in settings."));
             onSettingsClicked();
             return;
         }
-        m_ircClient->connectToTwitch(m_channel, m_username, m_oauthToken);
+        m_loginFailed = false;
+        QMetaObject::invokeMethod(m_ircWorker, "connectToTwitch",
+                                  Q_ARG(QStringList, m_channels),
+                                  Q_ARG(QString, m_username),
+                                  Q_ARG(QString, m_oauthToken));
     }
 }
 
 void FirstTimeChatterDock::onResetClicked()
 {
-    m_seenChatters.clear();
-    m_greetedChatters.clear();
-    m_chatterList->clear();
-    m_lastResetDate = QDate::currentDate();
-    saveSettings();
-    saveGreetedState();
+    resetAll(tr("reset button"));
 }
 
 void FirstTimeChatterDock::onSettingsClicked()
 {
     SettingsDialog dialog(this);
-    dialog.setChannel(m_channel);
+    dialog.setChannels(m_channels);
     dialog.setUsername(m_username);
     dialog.setOauthToken(m_oauthToken);
-    dialog.setBotList(QStringList(m_botList.begin(), m_botList.end()));
+    dialog.setServerUrl(m_serverUrl);
+    dialog.setBotList(m_botList);
+    dialog.setThreadedNetwork(m_threadedNetwork);
+    dialog.setCaptureTraffic(m_captureTraffic);
+    dialog.setEventLog(m_eventLogEnabled);
+    dialog.setOverlayPort(m_overlayPort);
+    dialog.setTextSources(TextSourceOutput::availableSources(), m_textSourceName);
+    dialog.setTextSourceLines(m_textSourceLines);
+    dialog.setResetOnStreamStart(m_resetOnStreamStart);
+    dialog.setResetTime(m_resetTime);
+    dialog.setResetIdleHours(m_resetIdleHours);
     
     if (dialog.exec() == QDialog::Accepted) {
-        m_channel = dialog.channel();
+        const QStringList channels = normalizedChannels(dialog.channels());
         m_username = dialog.username();
         m_oauthToken = dialog.oauthToken();
         
-        m_botList.clear();
-        QStringList bots = dialog.botList();
-        for (const QString &bot : bots) {
-            m_botList.insert(bot.toLower());
+        // Used from the next connect on
+        m_serverUrl = dialog.serverUrl();
+        QMetaObject::invokeMethod(m_ircWorker, "setServerUrl", Q_ARG(QUrl, QUrl(m_serverUrl)));
+        
+        m_botList = dialog.botList();
+        m_threadedNetwork = dialog.threadedNetwork();
+        
+        if (dialog.captureTraffic() != m_captureTraffic) {
+            m_captureTraffic = dialog.captureTraffic();
+            applyCaptureSetting();
+        }
+        
+        if (dialog.eventLog() != m_eventLogEnabled) {
+            m_eventLogEnabled = dialog.eventLog();
+            applyEventLogSetting();
+        }
+        
+        if (dialog.overlayPort() != m_overlayPort) {
+            m_overlayPort = dialog.overlayPort();
+            applyOverlaySetting();
+        }
+        
+        m_textSourceLines = dialog.textSourceLines();
+        m_textSourceName = dialog.textSource();
+        m_textOutput->setLineCount(m_textSourceLines);
+        m_textOutput->setSourceName(m_textSourceName);
+        
+        m_resetOnStreamStart = dialog.resetOnStreamStart();
+        m_resetIdleHours = dialog.resetIdleHours();
+        if (dialog.resetTime() != m_resetTime) {
+            m_resetTime = dialog.resetTime();
+            scheduleReset();
+        }
+        
+        // Joined and parted on the live connection, no reconnect needed
+        if (channels != m_channels) {
+            m_channels = channels;
+            applyChannels();
+            QMetaObject::invokeMethod(m_ircWorker, "setChannels", Q_ARG(QStringList, m_channels));
         }
         
         saveSettings();
+        
+        // Invalid rules are skipped; the rest still apply
+        QStringList errors = applyBotFilter();
+        if (!errors.isEmpty()) {
+            QMessageBox::warning(this, tr("Bot Filter"),
+                                 tr("Some bot filter rules were ignored:\n\n%1").arg(errors.join('\n')));
+        }
+    }
+}
+
+QStringList FirstTimeChatterDock::applyBotFilter()
+{
+    // Compiled once here; the worker only ever sees an immutable filter
+    QStringList errors;
+    std::shared_ptr<const BotFilter> filter = BotFilter::compile(m_botList, &errors);
+    IrcWorker *worker = m_ircWorker;
+    QMetaObject::invokeMethod(m_ircWorker, [worker, filter]() {
+        worker->setBotFilter(filter);
+    });
+    return errors;
+}
+
+void FirstTimeChatterDock::applyOverlaySetting()
+{
+    if (m_overlayPort <= 0) {
+        m_overlay->close();
+        return;
     }
+    if (!m_overlay->listen(static_cast<quint16>(m_overlayPort))) {
+        blog(LOG_WARNING, "[First-Time Chatter Dock] Overlay server could not listen on port %d", m_overlayPort);
+        return;
+    }
+    blog(LOG_INFO, "[First-Time Chatter Dock] Overlay at http://127.0.0.1:%d/", m_overlayPort);
 }
 
-void FirstTimeChatterDock::onChatterClicked(QListWidgetItem *item)
+void FirstTimeChatterDock::applyCaptureSetting()
 {
-    QString username = item->data(Qt::UserRole).toString();
+    if (!m_captureTraffic) {
+        QMetaObject::invokeMethod(m_ircWorker, "stopCapture");
+        return;
+    }
     
-    if (m_greetedChatters.contains(username)) {
+    // A new file per OBS session or toggle, so captures are never appended to
+    QString directory = QDir(configDirectory()).filePath(QStringLiteral("captures"));
+    QDir().mkpath(directory);
+    QString path = QDir(directory).filePath(QStringLiteral("capture-%1.ftcap")
+        .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    QMetaObject::invokeMethod(m_ircWorker, "startCapture", Q_ARG(QString, path));
+}
+
+void FirstTimeChatterDock::applyEventLogSetting()
+{
+    if (m_eventLogEnabled && !m_eventLog) {
+        m_eventLog = new ChatterEventLog(QDir(configDirectory()).filePath(QStringLiteral("logs/chatter-events.jsonl")));
+    } else if (!m_eventLogEnabled && m_eventLog) {
+        // Closes in the background; the settings dialog should not wait on the disk
+        m_eventLog->shutdownLater();
+        m_eventLog = nullptr;
+    }
+}
+
+void FirstTimeChatterDock::onChatterClicked(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    
+    ChannelState *state = currentChannelState();
+    if (!state) {
+        return;
+    }
+    
+    const int row = index.row();
+    quint64 key = state->model->key(row);
+    
+    const bool greeted = !state->greeted.keys.contains(key);
+    if (greeted) {
+        // Greet: add strikethrough
+        state->greeted.keys.insert(key);
+    } else {
         // Un-greet: remove strikethrough
-        m_greetedChatters.remove(username);
-        QFont font = item->font();
-        font.setStrikeOut(false);
-        item->setFont(font);
-        item->setForeground(QColor(0xef, 0xef, 0xf1));
+        state->greeted.keys.remove(key);
+    }
+    state->model->setGreeted(row, greeted);
+    const qint64 persistStartNs = IrcWorker::monotonicNs();
+    if (greeted) {
+        state->journal->recordGreeted(key);
     } else {
-        // Greet: add strikethrough
-        m_greetedChatters.insert(username);
-        QFont font = item->font();
-        font.setStrikeOut(true);
-        item->setFont(font);
-        item->setForeground(QColor(0x7a, 0x7a, 0x7d));
+        state->journal->recordUngreeted(key);
+    }
+    m_ircWorker->stats().record(PipelineStats::Persist, IrcWorker::monotonicNs() - persistStartNs);
+    m_overlay->chatterGreeted(state->name, key, greeted);
+    if (m_eventLog) {
+        m_eventLog->greeted(QDateTime::currentMSecsSinceEpoch(), state->name, key,
+                            state->model->registry().view(state->model->record(row).name),
+                            greeted);
     }
     
-    saveGreetedState();
+    if (state->journal->needsCompaction()) {
+        state->journal->compact(state->greeted);
+    }
+}
+
+void FirstTimeChatterDock::onChannelTabChanged(int index)
+{
+    Q_UNUSED(index)
+    ChannelState *state = currentChannelState();
+    if (state) {
+        onSearchTextChanged(m_searchEdit->text());
+    }
+    m_chatterList->setModel(state ? state->model : nullptr);
+    updateChatterCounts();
+}
+
+void FirstTimeChatterDock::onSearchTextChanged(const QString &text)
+{
+    ChannelState *state = currentChannelState();
+    if (!state) {
+        return;
+    }
+    
+    // Names have no spaces; allow pasting "@name" from chat
+    QString prefix = text.trimmed();
+    if (prefix.startsWith(QLatin1Char('@'))) {
+        prefix.remove(0, 1);
+    }
+    state->model->setFilter(prefix);
+    updateChatterCounts();
 }
 
 void FirstTimeChatterDock::onIrcConnected()
@@ -295,23 +1243,80 @@ void FirstTimeChatterDock::onIrcDisconnected()
     updateStatusIndicator();
 }
 
-void FirstTimeChatterDock::onIrcMessage(const QString &username, const QString &displayName, const QString &message)
+void FirstTimeChatterDock::onFirstChattersAvailable()
 {
-    Q_UNUSED(message)
+    // Bots and repeat chatters were already filtered on the network side
+    m_ircWorker->acknowledgeWakeup();
+    m_peakQueueDepth = qMax(m_peakQueueDepth, m_ircWorker->queueDepth());
     
-    // Check daily reset
-    checkDailyReset();
+    // Clocks are read once per pass rather than per chatter: the rows of a
+    // pass share their seen time. During a raid the queue is drained in
+    // slices, yielding to the event loop in between so OBS keeps painting
+    // and taking input; the clock is then read every few events.
+    qint64 nowNs = IrcWorker::monotonicNs();
+    const qint64 seenAtMs = QDateTime::currentMSecsSinceEpoch();
+    const bool sliced = m_ircWorker->isBurstMode();
+    const qint64 sliceEndNs = nowNs + DRAIN_SLICE_NS;
+    int drained = 0;
     
-    // Filter bots
-    if (isBot(username)) {
-        return;
+    FirstChatterEvent event;
+    while (m_ircWorker->popFirstChatter(event)) {
+        // Events enqueued after the clock was read count as handed off at once
+        const qint64 latencyNs = qMax<qint64>(0, nowNs - event.enqueuedNs);
+        m_ircWorker->stats().record(PipelineStats::Handoff, latencyNs);
+        m_queueEventCount++;
+        m_queueLatencyTotalNs += latencyNs;
+        m_queueLatencyMaxNs = qMax(m_queueLatencyMaxNs, latencyNs);
+        
+        if (event.generation == m_resetGeneration) {
+            addChatterToList(event, seenAtMs);
+        }
+        
+        if (sliced && ++drained % DRAIN_CLOCK_INTERVAL == 0) {
+            nowNs = IrcWorker::monotonicNs();
+            if (nowNs >= sliceEndNs) {
+                if (!m_drainScheduled) {
+                    m_drainScheduled = true;
+                    QTimer::singleShot(0, this, [this]() {
+                        m_drainScheduled = false;
+                        onFirstChattersAvailable();
+                    });
+                }
+                break;
+            }
+        }
     }
-    
-    // Check if first time chatter this session
-    if (!m_seenChatters.contains(username)) {
-        m_seenChatters.insert(username);
-        addChatterToList(displayName, username);
+}
+
+void FirstTimeChatterDock::onBurstModeChanged(bool bursting)
+{
+    const BurstDetector &burst = m_ircWorker->burstDetector();
+    if (bursting) {
+        blog(LOG_INFO, "[First-Time Chatter Dock] Raid mode on: chat passed %d messages/sec",
+             burst.enterRate());
+    } else {
+        blog(LOG_INFO, "[First-Time Chatter Dock] Raid mode off (%llu messages in raid mode so far, peak %llu messages/sec)",
+             static_cast<unsigned long long>(burst.burstMessages()),
+             static_cast<unsigned long long>(burst.peakRate()));
     }
+    updateStatusIndicator();
+}
+
+void FirstTimeChatterDock::onRaidReceived(const QString &channel, const QString &login, const QString &displayName,
+                                          int viewers)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    m_lastRaid = tr("%1 with %2 viewers into %3 at %4")
+        .arg(displayName)
+        .arg(viewers)
+        .arg(channel)
+        .arg(now.toString(QStringLiteral("HH:mm:ss")));
+    blog(LOG_INFO, "[First-Time Chatter Dock] Raid from %s with %d viewers into #%s",
+         login.toUtf8().constData(), viewers, channel.toUtf8().constData());
+    if (m_eventLog) {
+        m_eventLog->raid(now.toMSecsSinceEpoch(), channel, login, displayName, viewers);
+    }
+    updateNetworkStats();
 }
 
 void FirstTimeChatterDock::onIrcError(const QString &error)
@@ -320,8 +1325,47 @@ void FirstTimeChatterDock::onIrcError(const QString &error)
     updateStatusIndicator();
 }
 
+void FirstTimeChatterDock::onAuthenticationFailed(const QString &notice)
+{
+    blog(LOG_WARNING, "[First-Time Chatter Dock] Twitch rejected the login (%s); not reconnecting. "
+         "Check the username and OAuth token in settings.", notice.toUtf8().constData());
+    m_loginFailed = true;
+    m_reconnectAttempt = 0;
+    updateStatusIndicator();
+}
+
 void FirstTimeChatterDock::onConnectionStateChanged(TwitchIrcClient::ConnectionState state)
 {
-    Q_UNUSED(state)
+    m_connectionState = state;
+    if (state == TwitchIrcClient::ConnectionState::Connected) {
+        m_reconnectAttempt = 0;
+    }
     updateStatusIndicator();
 }
+
+void FirstTimeChatterDock::onRttMeasured(qint64 rttNs, qint64 smoothedRttNs)
+{
+    m_lastRttNs = rttNs;
+    m_smoothedRttNs = smoothedRttNs;
+}
+
+void FirstTimeChatterDock::onReconnectScheduled(int attempt, int delayMs)
+{
+    Q_UNUSED(delayMs)
+    m_reconnectAttempt = attempt;
+    updateStatusIndicator();
+}
+
+void FirstTimeChatterDock::onConnectionGap(qint64 startedMs, qint64 durationMs, const QString &reason)
+{
+    // First chatters during the gap were never seen
+    m_gapCount++;
+    m_blindTotalMs += durationMs;
+    m_lastGap = tr("%1 for %2 s (%3)")
+        .arg(QDateTime::fromMSecsSinceEpoch(startedMs).toString(QStringLiteral("HH:mm:ss")))
+        .arg(QString::number(durationMs / 1000.0, 'f', 1))
+        .arg(reason);
+    blog(LOG_WARNING, "[First-Time Chatter Dock] Chat connection lost for %lld ms: %s",
+         static_cast<long long>(durationMs), reason.toUtf8().constData());
+    updateNetworkStats();
+}
@@ -1,13 +1,37 @@
 #pragma once
 
 #include <QFrame>
-#include <QListWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QLabel>
+#include <QLineEdit>
 #include <QSet>
 #include <QSettings>
-#include <QDate>
+#include <QTabBar>
+#include <QToolButton>
+#include <QDateTime>
+#include <QTime>
+#include <QThread>
+#include <QTimer>
 #include "twitch-irc-client.hpp"
+#include "irc-worker.hpp"
+#include "chatter-list-model.hpp"
+#include "greeted-journal.hpp"
+#include "session-store.hpp"
+#include "persistence-writer.hpp"
+#include "overlay-server.hpp"
+#include "text-source-output.hpp"
+#include "chatter-event-log.hpp"
+#include <vector>
+
+// List and greeted state of one joined channel
+struct ChannelState {
+    QString name;  // Lowercase, without '#'
+    ChatterListModel *model = nullptr;
+    GreetedJournal *journal = nullptr;
+    SessionStore *session = nullptr;
+    GreetedState greeted;
+};
 
 class FirstTimeChatterDock : public QFrame {
     Q_OBJECT
@@ -20,39 +44,146 @@ private slots:
     void onConnectClicked();
     void onResetClicked();
     void onSettingsClicked();
-    void onChatterClicked(QListWidgetItem *item);
+    void onChatterClicked(const QModelIndex &index);
+    void onChannelTabChanged(int index);
+    void onSearchTextChanged(const QString &text);
     void onIrcConnected();
     void onIrcDisconnected();
-    void onIrcMessage(const QString &username, const QString &displayName, const QString &message);
+    void onFirstChattersAvailable();
     void onIrcError(const QString &error);
+    void onAuthenticationFailed(const QString &notice);
     void onConnectionStateChanged(TwitchIrcClient::ConnectionState state);
+    void onRttMeasured(qint64 rttNs, qint64 smoothedRttNs);
+    void onReconnectScheduled(int attempt, int delayMs);
+    void onConnectionGap(qint64 startedMs, qint64 durationMs, const QString &reason);
+    void onBurstModeChanged(bool bursting);
+    void onRaidReceived(const QString &channel, const QString &login, const QString &displayName, int viewers);
+    void onStreamingStarted();
+    void onSceneCollectionLoaded();
+    void onScheduledReset();
 
 private:
     void setupUi();
+    void setupNetwork();
     void applyDarkTheme();
     void loadSettings();
     void saveSettings();
-    void loadGreetedState();
+    void applyChannels();
+    ChannelState *channelState(const QString &name);
+    ChannelState *currentChannelState();
+    void loadGreetedState(ChannelState &state);
+    void restoreSession(ChannelState &state);
+    void seedSeenChatters(const ChannelState &state);
     void saveGreetedState();
-    void checkDailyReset();
+    void clearGreetedState();
+    void clearChatterLists();
+    void resetAll(const QString &reason);
+    void scheduleReset();
+    void checkMissedReset();
+    void checkIdleReset();
+    void resetSeenChatters();
     void updateStatusIndicator();
-    void addChatterToList(const QString &displayName, const QString &username);
-    bool isBot(const QString &username) const;
+    void updateNetworkStats();
+    QString connectionSummary() const;
+    QString commandSummary() const;
+    QString burstSummary() const;
+    QString resetSummary() const;
+    QString eventLogSummary() const;
+    QString memorySummary() const;
+    QString overlaySummary() const;
+    QString textOutputSummary() const;
+    void sampleTextOutputRate();
+    void updatePipelineStats();
+    void setStatsPanelExpanded(bool expanded);
+    void updateChatterCounts();
+    QStringList applyBotFilter();
+    void applyCaptureSetting();
+    void applyOverlaySetting();
+    void applyEventLogSetting();
+    bool isGreeted(ChannelState &state, quint64 key, const QString &username);
+    void addChatterToList(const FirstChatterEvent &event, qint64 seenAtMs);
 
-    TwitchIrcClient *m_ircClient;
-    QListWidget *m_chatterList;
+    IrcWorker *m_ircWorker;
+    QThread *m_networkThread;
+    PersistenceWriter *m_persistence;  // Settings writes and journal fsyncs
+    OverlayServer *m_overlay;          // Browser-source output, listening while enabled
+    TextSourceOutput *m_textOutput;    // Text-source output, idle without a source
+    ChatterEventLog *m_eventLog;       // Null unless activity logging is on
+    QTimer *m_networkStatsTimer;
+    QTimer *m_resetTimer;  // Fires for the daily reset time, rechecking hourly
+    TwitchIrcClient::ConnectionState m_connectionState;
+    QTabBar *m_channelTabs;
+    QLineEdit *m_searchEdit;
+    QListView *m_chatterList;
     QPushButton *m_connectButton;
     QPushButton *m_resetButton;
     QPushButton *m_settingsButton;
     QLabel *m_statusLabel;
+    QLabel *m_countsLabel;
+    QToolButton *m_statsToggle;
+    QLabel *m_statsLabel;
     
-    QSet<QString> m_seenChatters;
-    QSet<QString> m_greetedChatters;
-    QSet<QString> m_botList;
+    // One entry per joined channel, in tab order
+    std::vector<ChannelState> m_channelStates;
+    std::shared_ptr<ChatterRegistry> m_chatterNames;  // Shared by every channel's list
+    QStringList m_botList;  // Bot filter rules as entered
     
-    QString m_channel;
+    QStringList m_channels;  // Lowercase, without '#'
     QString m_username;
     QString m_oauthToken;
+    QString m_serverUrl;  // Empty for Twitch
+    bool m_threadedNetwork;
+    bool m_captureTraffic;
+    bool m_eventLogEnabled;
+    bool m_statsPanelExpanded;
+    int m_overlayPort;  // 0 when the overlay is off
+    QString m_textSourceName;  // Empty when the text output is off
+    int m_textSourceLines;
+    
+    // Reset policies; none of them does any work per message
+    bool m_resetOnStreamStart;
+    QTime m_resetTime;     // Invalid when there is no daily reset
+    int m_resetIdleHours;  // 0 when quiet chat never resets
+    QDateTime m_lastResetAt;
+    QString m_lastResetReason;
+    QDateTime m_nextScheduledReset;
+    
+    // Idle detection compares the worker's message count once a second
+    quint64 m_messagesAtIdleCheck;
+    qint64 m_lastActivityNs;
+    bool m_idleResetDone;  // Until chat resumes
+    // Wall time of the last chat message, saved now and then so a restart
+    // can tell how long chat was quiet; 0 if unknown
+    qint64 m_lastChatActivityMs;
+    qint64 m_chatActivitySavedNs;
+    
+    // Events produced before the last reset are dropped on arrival
+    quint32 m_resetGeneration;
+    
+    // Cross-thread hand-off statistics
+    size_t m_peakQueueDepth;
+    bool m_drainScheduled;  // A raid drain slice is waiting for the next event-loop pass
+    quint64 m_queueEventCount;
+    qint64 m_queueLatencyTotalNs;
+    qint64 m_queueLatencyMaxNs;
+    
+    // Connection health from the worker's supervisor
+    int m_reconnectAttempt;  // 0 unless waiting to reconnect
+    bool m_loginFailed;      // Until the user connects again
+    qint64 m_lastRttNs;
+    qint64 m_smoothedRttNs;
+    int m_gapCount;
+    qint64 m_blindTotalMs;
+    QString m_lastGap;
+    QString m_lastRaid;  // Announced by Twitch, whether or not raid mode engaged
+    
+    // Text source updates per second, measured over the stats timer's ticks
+    quint64 m_textUpdatesAtTick;
+    qint64 m_textTickNs;
+    double m_textUpdateRate;
     
-    QDate m_lastResetDate;
+    // Stage latency windows: the panel shows the last few seconds, the OBS
+    // log gets a summary per minute
+    PipelineStats::Snapshot m_panelWindowStart;
+    PipelineStats::Snapshot m_logWindowStart;
 };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+#include "chatter-key.hpp"
+
+// Open-addressing hash set of non-zero 64-bit chatter keys. Linear probing
+// with backward-shift deletion, so there are no tombstones and every element
+// costs one 8-byte slot instead of a hashed, heap-allocated QString.
+class FlatIdSet {
+public:
+    bool contains(quint64 key) const
+    {
+        if (key == 0 || m_slots.empty()) {
+            return false;
+        }
+        return m_slots[findSlot(key)] == key;
+    }
+
+    // Returns true if the key was not present before
+    bool insert(quint64 key)
+    {
+        if (key == 0) {
+            return false;
+        }
+        if ((m_size + 1) * 10 > m_slots.size() * 7) {
+            rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+        }
+
+        size_t slot = findSlot(key);
+        if (m_slots[slot] == key) {
+            return false;
+        }
+        m_slots[slot] = key;
+        m_size++;
+        return true;
+    }
+
+    bool remove(quint64 key)
+    {
+        if (key == 0 || m_slots.empty()) {
+            return false;
+        }
+
+        size_t hole = findSlot(key);
+        if (m_slots[hole] != key) {
+            return false;
+        }
+
+        // Pull later members of the probe run back so lookups never stop early
+        const size_t mask = m_slots.size() - 1;
+        size_t next = hole;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (m_slots[next] == 0) {
+                break;
+            }
+            const size_t home = ChatterKey::mix(m_slots[next]) & mask;
+            const bool movable = next > hole ? (home <= hole || home > next)
+                                             : (home <= hole && home > next);
+            if (movable) {
+                m_slots[hole] = m_slots[next];
+                hole = next;
+            }
+        }
+        m_slots[hole] = 0;
+        m_size--;
+        return true;
+    }
+
+    void clear()
+    {
+        m_slots.clear();
+        m_slots.shrink_to_fit();
+        m_size = 0;
+    }
+
+    void reserve(size_t count)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (count * 10 > capacity * 7) {
+            capacity *= 2;
+        }
+        if (capacity > m_slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    size_t size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    size_t memoryUsage() const { return m_slots.capacity() * sizeof(quint64); }
+
+    template<typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        for (quint64 key : m_slots) {
+            if (key != 0) {
+                fn(key);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    size_t findSlot(quint64 key) const
+    {
+        const size_t mask = m_slots.size() - 1;
+        size_t slot = ChatterKey::mix(key) & mask;
+        while (m_slots[slot] != 0 && m_slots[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<quint64> old(capacity, 0);
+        old.swap(m_slots);
+        for (quint64 key : old) {
+            if (key != 0) {
+                m_slots[findSlot(key)] = key;
+            }
+        }
+    }
+
+    std::vector<quint64> m_slots;
+    size_t m_size = 0;
+};
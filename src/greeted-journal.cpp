@@ -0,0 +1,394 @@
+#include "greeted-journal.hpp"
+#include "persistence-writer.hpp"
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char JOURNAL_MAGIC[4] = {'F', 'T', 'C', 'J'};
+static const char SNAPSHOT_MAGIC[4] = {'F', 'T', 'C', 'S'};
+static const quint32 JOURNAL_VERSION = 1;
+
+// Snapshots of any other version are ignored
+static const quint32 SNAPSHOT_VERSION = 2;
+
+// Journal: magic, version. Snapshot: magic, version, covered sequence.
+static const qsizetype JOURNAL_HEADER_SIZE = 8;
+static const qsizetype SNAPSHOT_HEADER_SIZE = 16;
+
+// Record: op (1), payload length (2), payload, CRC-16 (2). The payload is a
+// UTF-8 login or a 64-bit chatter key.
+static const qsizetype RECORD_OVERHEAD = 5;
+
+static const int SYNC_INTERVAL_MS = 1000;
+static const int COMPACTION_THRESHOLD = 1024;
+
+static void appendUInt16(QByteArray &out, quint16 value)
+{
+    char bytes[2];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 2);
+}
+
+static void appendUInt32(QByteArray &out, quint32 value)
+{
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+static void appendUInt64(QByteArray &out, quint64 value)
+{
+    char bytes[8];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 8);
+}
+
+static QByteArray keyPayload(quint64 key)
+{
+    QByteArray payload;
+    appendUInt64(payload, key);
+    return payload;
+}
+
+// Reads count length-prefixed UTF-8 logins; returns the offset after them
+static qsizetype readLogins(const QByteArray &data, qsizetype pos, quint32 count, QSet<QString> &logins)
+{
+    const char *bytes = data.constData();
+    for (quint32 i = 0; i < count && pos + 2 <= data.size(); ++i) {
+        const quint16 length = qFromLittleEndian<quint16>(bytes + pos);
+        if (pos + 2 + length > data.size()) {
+            return data.size();
+        }
+        logins.insert(QString::fromUtf8(bytes + pos + 2, length));
+        pos += 2 + length;
+    }
+    return pos;
+}
+
+GreetedJournal::GreetedJournal(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_sequence(0)
+    , m_recordCount(0)
+    , m_unsynced(false)
+    , m_syncTimer(new QTimer(this))
+{
+    m_syncTimer->setSingleShot(true);
+    m_syncTimer->setInterval(SYNC_INTERVAL_MS);
+    connect(m_syncTimer, &QTimer::timeout, this, &GreetedJournal::sync);
+
+    m_compactionPool.setMaxThreadCount(1);
+}
+
+GreetedJournal::~GreetedJournal()
+{
+    sync();
+    m_compactionPool.waitForDone();
+}
+
+GreetedState GreetedJournal::load()
+{
+    GreetedState state;
+    const quint64 coveredSequence = readSnapshot(snapshotPath(), state);
+
+    // Journals the snapshot already covers are leftovers of an interrupted compaction
+    quint64 lastSequence = coveredSequence;
+    const QList<quint64> sequences = journalSequences();
+    for (quint64 sequence : sequences) {
+        if (sequence <= coveredSequence) {
+            QFile::remove(journalPath(sequence));
+            continue;
+        }
+        m_recordCount += replayJournal(journalPath(sequence), state) + 1;
+        lastSequence = sequence;
+    }
+
+    // Never append behind a possibly torn tail; start a fresh journal instead
+    openJournal(lastSequence + 1);
+    return state;
+}
+
+void GreetedJournal::recordGreeted(quint64 key)
+{
+    append(OpGreetedKey, keyPayload(key));
+}
+
+void GreetedJournal::recordUngreeted(quint64 key)
+{
+    append(OpUngreetedKey, keyPayload(key));
+}
+
+void GreetedJournal::recordLegacyGreeted(const QString &login)
+{
+    append(OpGreetedLogin, login.toUtf8().left(0xffff));
+}
+
+void GreetedJournal::recordLegacyForgotten(const QString &login)
+{
+    append(OpUngreetedLogin, login.toUtf8().left(0xffff));
+}
+
+void GreetedJournal::recordClear()
+{
+    append(OpClear, QByteArray());
+}
+
+bool GreetedJournal::needsCompaction() const
+{
+    return m_recordCount >= COMPACTION_THRESHOLD && !m_compacting.load();
+}
+
+void GreetedJournal::compact(const GreetedState &state)
+{
+    if (m_compacting.exchange(true)) {
+        return;
+    }
+
+    // Seal the current journal; new records go to the next one
+    sync();
+    const quint64 coveredSequence = m_sequence;
+    m_journal.close();
+    openJournal(coveredSequence + 1);
+    m_recordCount = 0;
+
+    QStringList obsolete;
+    const QList<quint64> sequences = journalSequences();
+    for (quint64 sequence : sequences) {
+        if (sequence <= coveredSequence) {
+            obsolete.append(journalPath(sequence));
+        }
+    }
+
+    const QString path = snapshotPath();
+    m_compactionPool.start([this, path, coveredSequence, state, obsolete]() {
+        if (writeSnapshot(path, coveredSequence, state)) {
+            for (const QString &journal : obsolete) {
+                QFile::remove(journal);
+            }
+        }
+        m_compacting.store(false);
+    });
+}
+
+void GreetedJournal::sync()
+{
+    if (!m_unsynced || !m_journal.isOpen()) {
+        return;
+    }
+
+    m_journal.flush();
+    if (m_writer) {
+        m_writer->syncFile(m_journal.fileName());
+    } else {
+#ifdef Q_OS_WIN
+        _commit(m_journal.handle());
+#else
+        ::fsync(m_journal.handle());
+#endif
+    }
+    m_unsynced = false;
+    m_syncTimer->stop();
+}
+
+void GreetedJournal::append(Op op, const QByteArray &payload)
+{
+    if (!m_journal.isOpen()) {
+        return;
+    }
+
+    QByteArray record;
+    record.reserve(RECORD_OVERHEAD + payload.size());
+    record.append(static_cast<char>(op));
+    appendUInt16(record, static_cast<quint16>(payload.size()));
+    record.append(payload);
+    appendUInt16(record, qChecksum(record));
+
+    // Hand the record to the OS right away; fsync is batched by the timer
+    m_journal.write(record);
+    m_journal.flush();
+    m_recordCount++;
+
+    m_unsynced = true;
+    if (!m_syncTimer->isActive()) {
+        m_syncTimer->start();
+    }
+}
+
+bool GreetedJournal::openJournal(quint64 sequence)
+{
+    m_sequence = sequence;
+    m_journal.setFileName(journalPath(sequence));
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray header(JOURNAL_MAGIC, 4);
+    appendUInt32(header, JOURNAL_VERSION);
+    m_journal.write(header);
+    m_journal.flush();
+    return true;
+}
+
+QString GreetedJournal::journalPath(quint64 sequence) const
+{
+    return QDir(m_directory).filePath(QStringLiteral("greeted-%1.journal").arg(sequence, 8, 10, QChar('0')));
+}
+
+QString GreetedJournal::snapshotPath() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("greeted.snapshot"));
+}
+
+QList<quint64> GreetedJournal::journalSequences() const
+{
+    QList<quint64> sequences;
+    const QStringList files = QDir(m_directory).entryList({QStringLiteral("greeted-*.journal")}, QDir::Files);
+    for (const QString &file : files) {
+        bool ok = false;
+        quint64 sequence = QStringView(file).sliced(8, file.size() - 16).toULongLong(&ok);
+        if (ok) {
+            sequences.append(sequence);
+        }
+    }
+    std::sort(sequences.begin(), sequences.end());
+    return sequences;
+}
+
+quint64 GreetedJournal::readSnapshot(const QString &path, GreetedState &state)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    const QByteArray data = file.readAll();
+    const char *bytes = data.constData();
+    if (data.size() < SNAPSHOT_HEADER_SIZE + 4 || std::memcmp(bytes, SNAPSHOT_MAGIC, 4) != 0) {
+        return 0;
+    }
+
+    const quint32 version = qFromLittleEndian<quint32>(bytes + 4);
+    const quint64 coveredSequence = qFromLittleEndian<quint64>(bytes + 8);
+    qsizetype pos = SNAPSHOT_HEADER_SIZE;
+
+    if (version != SNAPSHOT_VERSION) {
+        return 0;
+    }
+
+    const quint32 keyCount = qFromLittleEndian<quint32>(bytes + pos);
+    pos += 4;
+    if (pos + qsizetype(keyCount) * 8 + 4 > data.size()) {
+        return 0;
+    }
+    state.keys.reserve(keyCount);
+    for (quint32 i = 0; i < keyCount; ++i, pos += 8) {
+        state.keys.insert(qFromLittleEndian<quint64>(bytes + pos));
+    }
+
+    const quint32 loginCount = qFromLittleEndian<quint32>(bytes + pos);
+    readLogins(data, pos + 4, loginCount, state.legacyLogins);
+    return coveredSequence;
+}
+
+int GreetedJournal::replayJournal(const QString &path, GreetedState &state)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    const QByteArray data = file.readAll();
+    const char *bytes = data.constData();
+    if (data.size() < JOURNAL_HEADER_SIZE ||
+        std::memcmp(bytes, JOURNAL_MAGIC, 4) != 0 ||
+        qFromLittleEndian<quint32>(bytes + 4) != JOURNAL_VERSION) {
+        return 0;
+    }
+
+    int records = 0;
+    qsizetype pos = JOURNAL_HEADER_SIZE;
+    while (pos + RECORD_OVERHEAD <= data.size()) {
+        const quint8 op = static_cast<quint8>(bytes[pos]);
+        const quint16 length = qFromLittleEndian<quint16>(bytes + pos + 1);
+        const char *payload = bytes + pos + 3;
+        const qsizetype end = pos + 3 + length;
+
+        // Stop at a torn or corrupt tail; everything before it is intact
+        if (end + 2 > data.size() ||
+            qChecksum(QByteArrayView(bytes + pos, end - pos)) != qFromLittleEndian<quint16>(bytes + end)) {
+            break;
+        }
+
+        switch (op) {
+            case OpGreetedLogin:
+                state.legacyLogins.insert(QString::fromUtf8(payload, length));
+                break;
+            case OpUngreetedLogin:
+                state.legacyLogins.remove(QString::fromUtf8(payload, length));
+                break;
+            case OpClear:
+                state.clear();
+                break;
+            case OpGreetedKey:
+                if (length == 8) {
+                    state.keys.insert(qFromLittleEndian<quint64>(payload));
+                }
+                break;
+            case OpUngreetedKey:
+                if (length == 8) {
+                    state.keys.remove(qFromLittleEndian<quint64>(payload));
+                }
+                break;
+            default:
+                break;
+        }
+
+        pos = end + 2;
+        records++;
+    }
+    return records;
+}
+
+bool GreetedJournal::writeSnapshot(const QString &path, quint64 coveredSequence, const GreetedState &state)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray buffer(SNAPSHOT_MAGIC, 4);
+    appendUInt32(buffer, SNAPSHOT_VERSION);
+    appendUInt64(buffer, coveredSequence);
+
+    appendUInt32(buffer, static_cast<quint32>(state.keys.size()));
+    state.keys.forEach([&](quint64 key) {
+        appendUInt64(buffer, key);
+        if (buffer.size() >= 64 * 1024) {
+            file.write(buffer);
+            buffer.truncate(0);
+        }
+    });
+
+    appendUInt32(buffer, static_cast<quint32>(state.legacyLogins.size()));
+    for (const QString &login : state.legacyLogins) {
+        const QByteArray name = login.toUtf8().left(0xffff);
+        appendUInt16(buffer, static_cast<quint16>(name.size()));
+        buffer.append(name);
+        if (buffer.size() >= 64 * 1024) {
+            file.write(buffer);
+            buffer.truncate(0);
+        }
+    }
+    file.write(buffer);
+
+    // QSaveFile syncs and atomically replaces the old snapshot
+    return file.commit();
+}
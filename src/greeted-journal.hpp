@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include "flat-id-set.hpp"
+
+class PersistenceWriter;
+
+struct GreetedState {
+    FlatIdSet keys;
+
+    // Logins from name-based saves, matched by login until their chatter
+    // shows up again and is migrated to a key
+    QSet<QString> legacyLogins;
+
+    void clear()
+    {
+        keys.clear();
+        legacyLogins.clear();
+    }
+};
+
+// Greeted state stored as an append-only journal of small toggle records.
+// Journals are numbered; compaction switches appends to the next journal and
+// writes the full state as a snapshot on a background thread, after which
+// the journals it covers are deleted. Records are flushed to the OS as they
+// are written and fsynced at most SYNC_INTERVAL_MS later, so a crash loses
+// at most that interval. With a PersistenceWriter set, the fsync itself runs
+// on the writer's thread.
+class GreetedJournal : public QObject {
+    Q_OBJECT
+
+public:
+    explicit GreetedJournal(const QString &directory, QObject *parent = nullptr);
+    ~GreetedJournal() override;
+
+    // Replays the snapshot and any newer journals. Call once before recording.
+    GreetedState load();
+
+    void recordGreeted(quint64 key);
+    void recordUngreeted(quint64 key);
+    void recordLegacyGreeted(const QString &login);
+    void recordLegacyForgotten(const QString &login);
+    void recordClear();
+
+    // True once enough records piled up to be worth a snapshot
+    bool needsCompaction() const;
+
+    // Snapshots state (which must reflect every record so far) in the background
+    void compact(const GreetedState &state);
+
+    // Hands buffered records to the OS and fsyncs them, or with a
+    // PersistenceWriter set queues the fsync on its thread
+    void sync();
+
+    // Null to fsync on the calling thread again
+    void setPersistenceWriter(PersistenceWriter *writer) { m_writer = writer; }
+
+private:
+    // Login ops date from the name-keyed format and now only track legacy logins
+    enum Op : quint8 {
+        OpGreetedLogin = 1,
+        OpUngreetedLogin = 2,
+        OpClear = 3,
+        OpGreetedKey = 4,
+        OpUngreetedKey = 5
+    };
+
+    void append(Op op, const QByteArray &payload);
+    bool openJournal(quint64 sequence);
+    QString journalPath(quint64 sequence) const;
+    QString snapshotPath() const;
+    QList<quint64> journalSequences() const;
+    static quint64 readSnapshot(const QString &path, GreetedState &state);
+    static int replayJournal(const QString &path, GreetedState &state);
+    static bool writeSnapshot(const QString &path, quint64 coveredSequence, const GreetedState &state);
+
+    QString m_directory;
+    QFile m_journal;
+    quint64 m_sequence;
+    int m_recordCount;
+    bool m_unsynced;
+    QTimer *m_syncTimer;
+    PersistenceWriter *m_writer = nullptr;
+    std::atomic<bool> m_compacting{false};
+    QThreadPool m_compactionPool;
+};
@@ -0,0 +1,151 @@
+#include "irc-capture.hpp"
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+
+static const char CAPTURE_MAGIC[4] = {'F', 'T', 'C', 'C'};
+static const quint32 CAPTURE_VERSION = 1;
+static const qint64 CAPTURE_HEADER_SIZE = 16;
+
+static void appendVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+static bool readVarint(const uchar *data, qint64 size, qint64 &pos, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        const uchar byte = data[pos++];
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+IrcCaptureWriter::~IrcCaptureWriter()
+{
+    close();
+}
+
+bool IrcCaptureWriter::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    // Each frame goes to the OS as it arrives, so a crash loses nothing;
+    // QFile's own buffer would only hold it back
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    char header[CAPTURE_HEADER_SIZE];
+    std::memcpy(header, CAPTURE_MAGIC, 4);
+    qToLittleEndian(CAPTURE_VERSION, header + 4);
+    qToLittleEndian(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    m_file.write(header, CAPTURE_HEADER_SIZE);
+
+    m_lastNs = -1;
+    m_frameCount = 0;
+    return true;
+}
+
+void IrcCaptureWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    m_buffer.clear();
+    m_file.close();
+}
+
+void IrcCaptureWriter::write(qint64 monotonicNs, QStringView frame)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    const qint64 deltaNs = m_lastNs < 0 ? 0 : qMax<qint64>(0, monotonicNs - m_lastNs);
+    m_lastNs = monotonicNs;
+
+    const QByteArray text = frame.toUtf8();
+    appendVarint(m_buffer, static_cast<quint64>(deltaNs));
+    appendVarint(m_buffer, static_cast<quint64>(text.size()));
+    m_buffer.append(text);
+    m_frameCount++;
+
+    // Handed to the page cache before the frame is parsed, so the frame
+    // that crashes the process is in the capture; no fsync is needed for that
+    m_file.write(m_buffer);
+    m_buffer.truncate(0);
+}
+
+IrcCaptureReader::~IrcCaptureReader()
+{
+    close();
+}
+
+bool IrcCaptureReader::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < CAPTURE_HEADER_SIZE) {
+        m_file.close();
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    if (!m_data || std::memcmp(m_data, CAPTURE_MAGIC, 4) != 0 ||
+        qFromLittleEndian<quint32>(m_data + 4) != CAPTURE_VERSION) {
+        close();
+        return false;
+    }
+
+    m_startedAtMs = qFromLittleEndian<qint64>(m_data + 8);
+    rewind();
+    return true;
+}
+
+void IrcCaptureReader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+}
+
+bool IrcCaptureReader::next(IrcCaptureFrame &frame)
+{
+    if (!m_data) {
+        return false;
+    }
+
+    qint64 pos = m_pos;
+    quint64 deltaNs = 0;
+    quint64 length = 0;
+    if (!readVarint(m_data, m_size, pos, deltaNs) ||
+        !readVarint(m_data, m_size, pos, length) ||
+        length > quint64(m_size - pos)) {
+        return false;
+    }
+
+    m_offsetNs += static_cast<qint64>(deltaNs);
+    frame.offsetNs = m_offsetNs;
+    frame.text = QString::fromUtf8(reinterpret_cast<const char *>(m_data + pos), static_cast<qsizetype>(length));
+    m_pos = pos + static_cast<qint64>(length);
+    return true;
+}
+
+void IrcCaptureReader::rewind()
+{
+    m_pos = CAPTURE_HEADER_SIZE;
+    m_offsetNs = 0;
+}
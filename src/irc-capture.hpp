@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QStringView>
+
+// Capture file of raw IRC WebSocket frames for offline replay.
+//
+// Header: magic "FTCC", version (u32), wall-clock start in ms since the epoch
+// (i64). Then one record per frame: nanoseconds since the previous frame and
+// the UTF-8 length, both as LEB128 varints, followed by the UTF-8 bytes. A
+// torn tail from an interrupted recording is ignored on read.
+
+struct IrcCaptureFrame {
+    qint64 offsetNs = 0;  // Since the first frame of the capture
+    QString text;
+};
+
+class IrcCaptureWriter {
+public:
+    ~IrcCaptureWriter();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+
+    // monotonicNs must not go backwards between calls
+    void write(qint64 monotonicNs, QStringView frame);
+
+    quint64 frameCount() const { return m_frameCount; }
+
+private:
+    QFile m_file;
+    QByteArray m_buffer;  // One encoded record, reused
+    qint64 m_lastNs = -1;
+    quint64 m_frameCount = 0;
+};
+
+class IrcCaptureReader {
+public:
+    ~IrcCaptureReader();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Returns false at the end of the capture or at a torn record
+    bool next(IrcCaptureFrame &frame);
+    void rewind();
+
+    qint64 startedAtMs() const { return m_startedAtMs; }
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_pos = 0;
+    qint64 m_offsetNs = 0;
+    qint64 m_startedAtMs = 0;
+};
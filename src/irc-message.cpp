@@ -0,0 +1,261 @@
+#include "irc-message.hpp"
+
+static qsizetype skipSpaces(QStringView line, qsizetype pos)
+{
+    while (pos < line.size() && line[pos] == u' ') {
+        ++pos;
+    }
+    return pos;
+}
+
+bool IrcMessageView::parse(QStringView line)
+{
+    *this = IrcMessageView();
+
+    const qsizetype length = line.size();
+    qsizetype pos = 0;
+
+    // Tags: @key=value;key=value
+    if (pos < length && line[pos] == u'@') {
+        qsizetype spaceIndex = line.indexOf(u' ', pos);
+        if (spaceIndex == -1) {
+            return false;
+        }
+        tags = line.sliced(pos + 1, spaceIndex - pos - 1);
+        pos = skipSpaces(line, spaceIndex);
+    }
+
+    // Prefix: :nick!user@host
+    if (pos < length && line[pos] == u':') {
+        qsizetype spaceIndex = line.indexOf(u' ', pos);
+        if (spaceIndex == -1) {
+            return false;
+        }
+        prefix = line.sliced(pos + 1, spaceIndex - pos - 1);
+        pos = skipSpaces(line, spaceIndex);
+    }
+
+    // Command
+    qsizetype commandEnd = line.indexOf(u' ', pos);
+    if (commandEnd == -1) {
+        commandEnd = length;
+    }
+    command = line.sliced(pos, commandEnd - pos);
+    if (command.isEmpty()) {
+        return false;
+    }
+    pos = skipSpaces(line, commandEnd);
+
+    // Params up to the trailing parameter, which starts at the first " :"
+    if (pos < length && line[pos] == u':') {
+        trailing = line.sliced(pos + 1);
+        return true;
+    }
+
+    qsizetype trailingIndex = line.indexOf(QStringView(u" :"), pos);
+    if (trailingIndex == -1) {
+        params = line.sliced(pos).trimmed();
+    } else {
+        params = line.sliced(pos, trailingIndex - pos).trimmed();
+        trailing = line.sliced(trailingIndex + 2);
+    }
+    return true;
+}
+
+QStringView IrcMessageView::tag(QStringView key) const
+{
+    qsizetype start = 0;
+    while (start < tags.size()) {
+        qsizetype end = tags.indexOf(u';', start);
+        if (end == -1) {
+            end = tags.size();
+        }
+
+        QStringView entry = tags.sliced(start, end - start);
+        if (entry.size() >= key.size() && entry.startsWith(key)) {
+            if (entry.size() == key.size()) {
+                // Key without a value
+                return entry.sliced(entry.size());
+            }
+            if (entry[key.size()] == u'=') {
+                return entry.sliced(key.size() + 1);
+            }
+        }
+        start = end + 1;
+    }
+    return QStringView();
+}
+
+QString IrcMessageView::tagValue(QStringView key) const
+{
+    QStringView value = tag(key);
+    if (value.isEmpty()) {
+        return QString();
+    }
+    return unescapeIrcTagValue(value);
+}
+
+QStringView IrcMessageView::nick() const
+{
+    qsizetype exclamIndex = prefix.indexOf(u'!');
+    if (exclamIndex == -1) {
+        return prefix;
+    }
+    return prefix.first(exclamIndex);
+}
+
+QStringView ircCommandToken(QStringView line)
+{
+    qsizetype pos = 0;
+    if (pos < line.size() && line[pos] == u'@') {
+        pos = line.indexOf(u' ', pos);
+        if (pos == -1) {
+            return QStringView();
+        }
+        pos = skipSpaces(line, pos);
+    }
+    if (pos < line.size() && line[pos] == u':') {
+        pos = line.indexOf(u' ', pos);
+        if (pos == -1) {
+            return QStringView();
+        }
+        pos = skipSpaces(line, pos);
+    }
+
+    qsizetype end = line.indexOf(u' ', pos);
+    if (end == -1) {
+        end = line.size();
+    }
+    return end > pos ? line.sliced(pos, end - pos) : QStringView();
+}
+
+IrcCommand ircCommandOf(QStringView token)
+{
+    // Length first, so most lines are told apart by one or two comparisons
+    switch (token.size()) {
+        case 3:
+            if (token[0].isDigit()) {
+                return IrcCommand::Numeric;
+            }
+            if (token == QStringView(u"CAP")) {
+                return IrcCommand::Cap;
+            }
+            break;
+        case 4:
+            if (token == QStringView(u"PING")) {
+                return IrcCommand::Ping;
+            }
+            if (token == QStringView(u"PONG")) {
+                return IrcCommand::Pong;
+            }
+            if (token == QStringView(u"JOIN")) {
+                return IrcCommand::Join;
+            }
+            if (token == QStringView(u"PART")) {
+                return IrcCommand::Part;
+            }
+            break;
+        case 6:
+            if (token == QStringView(u"NOTICE")) {
+                return IrcCommand::Notice;
+            }
+            break;
+        case 7:
+            if (token == QStringView(u"PRIVMSG")) {
+                return IrcCommand::Privmsg;
+            }
+            if (token == QStringView(u"WHISPER")) {
+                return IrcCommand::Whisper;
+            }
+            break;
+        case 8:
+            if (token == QStringView(u"CLEARMSG")) {
+                return IrcCommand::Clearmsg;
+            }
+            break;
+        case 9:
+            if (token == QStringView(u"USERSTATE")) {
+                return IrcCommand::Userstate;
+            }
+            if (token == QStringView(u"ROOMSTATE")) {
+                return IrcCommand::Roomstate;
+            }
+            if (token == QStringView(u"CLEARCHAT")) {
+                return IrcCommand::Clearchat;
+            }
+            if (token == QStringView(u"RECONNECT")) {
+                return IrcCommand::Reconnect;
+            }
+            break;
+        case 10:
+            if (token == QStringView(u"USERNOTICE")) {
+                return IrcCommand::Usernotice;
+            }
+            if (token == QStringView(u"HOSTTARGET")) {
+                return IrcCommand::Hosttarget;
+            }
+            break;
+        case 15:
+            if (token == QStringView(u"GLOBALUSERSTATE")) {
+                return IrcCommand::Globaluserstate;
+            }
+            break;
+        default:
+            break;
+    }
+    return IrcCommand::Other;
+}
+
+const char *ircCommandName(IrcCommand command)
+{
+    switch (command) {
+        case IrcCommand::Privmsg:         return "PRIVMSG";
+        case IrcCommand::Ping:            return "PING";
+        case IrcCommand::Pong:            return "PONG";
+        case IrcCommand::Usernotice:      return "USERNOTICE";
+        case IrcCommand::Userstate:       return "USERSTATE";
+        case IrcCommand::Roomstate:       return "ROOMSTATE";
+        case IrcCommand::Globaluserstate: return "GLOBALUSERSTATE";
+        case IrcCommand::Clearchat:       return "CLEARCHAT";
+        case IrcCommand::Clearmsg:        return "CLEARMSG";
+        case IrcCommand::Notice:          return "NOTICE";
+        case IrcCommand::Whisper:         return "WHISPER";
+        case IrcCommand::Hosttarget:      return "HOSTTARGET";
+        case IrcCommand::Reconnect:       return "RECONNECT";
+        case IrcCommand::Join:            return "JOIN";
+        case IrcCommand::Part:            return "PART";
+        case IrcCommand::Cap:             return "CAP";
+        case IrcCommand::Numeric:         return "numeric";
+        case IrcCommand::Other:           break;
+    }
+    return "other";
+}
+
+QString unescapeIrcTagValue(QStringView value)
+{
+    if (value.indexOf(u'\\') == -1) {
+        return value.toString();
+    }
+
+    QString result;
+    result.reserve(value.size());
+    for (qsizetype i = 0; i < value.size(); ++i) {
+        QChar c = value[i];
+        if (c != u'\\') {
+            result.append(c);
+            continue;
+        }
+        if (++i >= value.size()) {
+            // A trailing lone backslash is dropped
+            break;
+        }
+        switch (value[i].unicode()) {
+            case u's': result.append(u' '); break;
+            case u':': result.append(u';'); break;
+            case u'r': result.append(u'\r'); break;
+            case u'n': result.append(u'\n'); break;
+            default:   result.append(value[i]); break;
+        }
+    }
+    return result;
+}
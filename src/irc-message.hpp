@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+
+// Non-owning view of one IRCv3 line: @tags :prefix COMMAND params :trailing
+// Every field points into the buffer handed to parse(), so the view must not
+// outlive it. Nothing is copied until a caller asks for a QString.
+struct IrcMessageView {
+    QStringView tags;
+    QStringView prefix;
+    QStringView command;
+    QStringView params;
+    QStringView trailing;
+
+    // Tokenizes the line in a single pass. Returns false for malformed input.
+    bool parse(QStringView line);
+
+    // Raw (still escaped) value of a tag, or a null view if it is not present
+    QStringView tag(QStringView key) const;
+
+    // Unescaped copy of a tag value; only allocates when the tag is present
+    QString tagValue(QStringView key) const;
+
+    // Nick part of a nick!user@host prefix
+    QStringView nick() const;
+};
+
+// Commands the client tells apart before parsing a line; anything else is Other
+enum class IrcCommand : quint8 {
+    Privmsg,
+    Ping,
+    Pong,
+    Usernotice,
+    Userstate,
+    Roomstate,
+    Globaluserstate,
+    Clearchat,
+    Clearmsg,
+    Notice,
+    Whisper,
+    Hosttarget,
+    Reconnect,
+    Join,
+    Part,
+    Cap,
+    Numeric,  // 001, 353, 366, ...
+    Other
+};
+
+constexpr int IrcCommandCount = static_cast<int>(IrcCommand::Other) + 1;
+
+// Locates the command token of a raw line without tokenizing the tag block
+// or the prefix: each is skipped with a single scan for the next space.
+// Returns a null view for lines that have no command.
+QStringView ircCommandToken(QStringView line);
+
+// Classifies a command token by length and a few characters
+IrcCommand ircCommandOf(QStringView token);
+
+// Wire name, e.g. "PRIVMSG"; "numeric" and "other" for the catch-alls
+const char *ircCommandName(IrcCommand command);
+
+// Calls fn(QStringView) for every non-empty CRLF-separated line of a frame
+template<typename Fn>
+void forEachIrcLine(QStringView frame, Fn &&fn)
+{
+    qsizetype start = 0;
+    while (start < frame.size()) {
+        qsizetype end = frame.indexOf(QStringView(u"\r\n"), start);
+        if (end == -1) {
+            end = frame.size();
+        }
+        if (end > start) {
+            fn(frame.sliced(start, end - start));
+        }
+        start = end + 2;
+    }
+}
+
+// Reverses IRCv3 tag value escaping (\s \: \\ \r \n)
+QString unescapeIrcTagValue(QStringView value);
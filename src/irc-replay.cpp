@@ -0,0 +1,81 @@
+#include "irc-replay.hpp"
+#include <QDeadlineTimer>
+#include <cmath>
+
+// Unpaced replay hands over this many frames per event-loop iteration
+static const int UNPACED_SLICE = 32;
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+IrcReplayDriver::IrcReplayDriver(FrameSink sink, QObject *parent)
+    : QObject(parent)
+    , m_sink(std::move(sink))
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &IrcReplayDriver::replayDue);
+}
+
+bool IrcReplayDriver::start(const QString &path, double speed)
+{
+    stop();
+    if (!m_reader.open(path)) {
+        return false;
+    }
+
+    m_speed = speed;
+    m_running = true;
+    m_framesReplayed = 0;
+    m_elapsedNs = 0;
+    m_hasNext = m_reader.next(m_next);
+    m_startNs = nowNs();
+    m_timer->start(0);
+    return true;
+}
+
+void IrcReplayDriver::stop()
+{
+    m_timer->stop();
+    m_reader.close();
+    m_running = false;
+    m_hasNext = false;
+}
+
+void IrcReplayDriver::replayDue()
+{
+    const bool paced = m_speed > 0;
+    int delivered = 0;
+
+    while (m_hasNext) {
+        if (paced) {
+            const qint64 dueNs = m_startNs + static_cast<qint64>(m_next.offsetNs / m_speed);
+            const qint64 waitNs = dueNs - nowNs();
+            if (waitNs > 0) {
+                m_timer->start(static_cast<int>(std::ceil(waitNs / 1e6)));
+                return;
+            }
+        } else if (delivered == UNPACED_SLICE) {
+            m_timer->start(0);
+            return;
+        }
+
+        m_sink(m_next.text);
+        m_framesReplayed++;
+        delivered++;
+        m_hasNext = m_reader.next(m_next);
+    }
+
+    finish();
+}
+
+void IrcReplayDriver::finish()
+{
+    m_elapsedNs = nowNs() - m_startNs;
+    m_reader.close();
+    m_running = false;
+    emit finished();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <functional>
+#include "irc-capture.hpp"
+
+// Feeds a capture file into a frame sink on the caller's event loop, either
+// paced by the recorded timestamps (scaled by speed) or as fast as possible.
+// Frames are delivered in slices so queued consumers get to run in between.
+class IrcReplayDriver : public QObject {
+    Q_OBJECT
+
+public:
+    using FrameSink = std::function<void(const QString &frame)>;
+
+    explicit IrcReplayDriver(FrameSink sink, QObject *parent = nullptr);
+
+    // speed 1.0 is real time, 10.0 ten times faster, <= 0 unpaced
+    bool start(const QString &path, double speed);
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    quint64 framesReplayed() const { return m_framesReplayed; }
+    qint64 elapsedNs() const { return m_elapsedNs; }
+
+signals:
+    void finished();
+
+private slots:
+    void replayDue();
+
+private:
+    void finish();
+
+    FrameSink m_sink;
+    IrcCaptureReader m_reader;
+    IrcCaptureFrame m_next;
+    QTimer *m_timer;
+    double m_speed = 1.0;
+    bool m_running = false;
+    bool m_hasNext = false;
+    qint64 m_startNs = 0;
+    qint64 m_elapsedNs = 0;
+    quint64 m_framesReplayed = 0;
+};
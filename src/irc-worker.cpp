@@ -0,0 +1,304 @@
+#include "irc-worker.hpp"
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QTimer>
+#include "chatter-key.hpp"
+
+// Enough for a large raid between two dock event-loop iterations
+static const size_t QUEUE_CAPACITY = 4096;
+
+IrcWorker::IrcWorker(QObject *parent)
+    : QObject(parent)
+    , m_client(new TwitchIrcClient(this))
+    , m_supervisor(new ConnectionSupervisor(m_client, this))
+    , m_replay(new IrcReplayDriver([this](const QString &frame) { m_client->injectFrame(frame); }, this))
+    , m_queue(QUEUE_CAPACITY)
+{
+    m_client->setStats(&m_stats);
+    connect(m_client, &TwitchIrcClient::connected, this, &IrcWorker::connected);
+    connect(m_client, &TwitchIrcClient::disconnected, this, &IrcWorker::disconnected);
+    connect(m_client, &TwitchIrcClient::connectionError, this, &IrcWorker::connectionError);
+    connect(m_client, &TwitchIrcClient::authenticationFailed, this, &IrcWorker::authenticationFailed);
+    connect(m_client, &TwitchIrcClient::connectionStateChanged, this, &IrcWorker::connectionStateChanged);
+    connect(m_client, &TwitchIrcClient::burstModeChanged, this, &IrcWorker::burstModeChanged);
+    // Called on this thread while the frame is parsed; CLEARCHAT and
+    // CLEARMSG have no subscriber and are never parsed
+    m_client->chatEvents().subscribe(ChatEvent::Kind::Message,
+                                     [this](const ChatEvent &event) { onChatMessage(event); });
+    m_client->chatEvents().subscribe(ChatEvent::Kind::UserNotice,
+                                     [this](const ChatEvent &event) { onUserNotice(event); });
+    connect(m_supervisor, &ConnectionSupervisor::rttMeasured, this, &IrcWorker::rttMeasured);
+    connect(m_supervisor, &ConnectionSupervisor::reconnectScheduled, this, &IrcWorker::reconnectScheduled);
+    connect(m_supervisor, &ConnectionSupervisor::connectionGap, this, &IrcWorker::connectionGap);
+    connect(m_replay, &IrcReplayDriver::finished, this, [this]() {
+        emit replayFinished(m_replay->framesReplayed(), m_replay->elapsedNs());
+    });
+}
+
+IrcWorker::~IrcWorker()
+{
+    m_supervisor->stop();
+    m_client->disconnect();
+}
+
+qint64 IrcWorker::monotonicNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+void IrcWorker::setStateDirectory(const QString &directory)
+{
+    m_stateDirectory = directory;
+}
+
+void IrcWorker::setServerUrl(const QUrl &url)
+{
+    m_client->setServerUrl(url);
+}
+
+void IrcWorker::connectToTwitch(const QStringList &channels, const QString &username, const QString &oauthToken)
+{
+    updateShards(channels);
+    m_client->connectToTwitch(channels, username, oauthToken);
+    m_supervisor->start();
+}
+
+void IrcWorker::setChannels(const QStringList &channels)
+{
+    updateShards(channels);
+    m_client->setChannels(channels);
+}
+
+void IrcWorker::setBurstEnterRate(int messagesPerSecond)
+{
+    m_client->setBurstEnterRate(messagesPerSecond);
+}
+
+void IrcWorker::updateShards(const QStringList &channels)
+{
+    std::vector<std::unique_ptr<ChannelShard>> shards;
+    m_shardIndex.clear();
+
+    for (const QString &channel : channels) {
+        QString name = channel.trimmed().toLower();
+        name.remove(QLatin1Char('#'));
+        const quint64 nameKey = ChatterKey::fromLogin(name);
+        if (name.isEmpty() || m_shardIndex.count(nameKey)) {
+            continue;
+        }
+
+        // Channels that stay keep their seen set across reconnects and edits
+        std::unique_ptr<ChannelShard> shard;
+        for (std::unique_ptr<ChannelShard> &existing : m_shards) {
+            if (existing && existing->name == name) {
+                shard = std::move(existing);
+                break;
+            }
+        }
+        if (!shard) {
+            shard = std::make_unique<ChannelShard>();
+            shard->name = name;
+        }
+        if (!m_stateDirectory.isEmpty()) {
+            shard->tracker.openLifetimeIndex(QDir(m_stateDirectory).filePath(QStringLiteral("lifetime-%1.idx").arg(name)));
+        }
+
+        m_shardIndex.emplace(nameKey, shard.get());
+        shards.push_back(std::move(shard));
+    }
+    m_shards = std::move(shards);
+}
+
+IrcWorker::ChannelShard *IrcWorker::shardFor(QStringView channel) const
+{
+    if (channel.startsWith(u'#')) {
+        channel = channel.sliced(1);
+    }
+    auto it = m_shardIndex.find(ChatterKey::fromLogin(channel));
+    if (it == m_shardIndex.end() || it->second->name != channel) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void IrcWorker::disconnectFromTwitch()
+{
+    m_supervisor->stop();
+    m_client->disconnect();
+}
+
+void IrcWorker::setBotFilter(std::shared_ptr<const BotFilter> filter)
+{
+    m_botFilter = std::move(filter);
+}
+
+void IrcWorker::seedSeen(const QString &channel, const std::vector<quint64> &keys)
+{
+    ChannelShard *shard = shardFor(channel);
+    if (!shard) {
+        // Not joined yet; updateShards() keeps this shard when it is
+        auto created = std::make_unique<ChannelShard>();
+        created->name = channel;
+        shard = created.get();
+        m_shardIndex.emplace(ChatterKey::fromLogin(channel), shard);
+        m_shards.push_back(std::move(created));
+    }
+    shard->tracker.restoreSeen(keys);
+}
+
+void IrcWorker::resetSeen(quint32 generation)
+{
+    m_generation = generation;
+    for (const std::unique_ptr<ChannelShard> &shard : m_shards) {
+        shard->tracker.reset();
+    }
+    m_pending.clear();
+}
+
+void IrcWorker::startCapture(const QString &path)
+{
+    m_client->startCapture(path);
+}
+
+void IrcWorker::stopCapture()
+{
+    m_client->stopCapture();
+}
+
+void IrcWorker::replayCapture(const QString &path, double speed)
+{
+    if (!m_replay->start(path, speed)) {
+        emit replayFinished(0, 0);
+    }
+}
+
+void IrcWorker::onChatMessage(const ChatEvent &message)
+{
+    ChannelShard *shard = shardFor(message.channel);
+    if (!shard) {
+        return;
+    }
+
+    m_stats.countMessage();
+    const bool timed = m_client->isLineTimed();
+    qint64 startNs = timed ? monotonicNs() : 0;
+
+    const quint64 key = ChatterKey::forChatter(message.userId, message.login);
+
+    // Repeat chatters, bots included, stop here before anything is copied
+    const bool firstSighting = shard->tracker.markSeen(key);
+    if (timed) {
+        m_stats.record(PipelineStats::Dedup, monotonicNs() - startNs);
+    }
+    if (!firstSighting) {
+        return;
+    }
+
+    // During a raid the client only located the sender; the rest of the
+    // line is parsed for first sightings alone
+    ChatEvent parsed;
+    if (!message.complete) {
+        parsed.parse(message.kind, *message.message);
+    }
+    const ChatEvent &chat = message.complete ? message : parsed;
+
+    const QString username = chat.login.toString().toLower();
+    QString displayName = unescapeIrcTagValue(chat.displayName);
+    if (displayName.isEmpty()) {
+        displayName = username;
+    }
+
+    // During a raid only what detection needs is done: no stage timing and
+    // no copy of the message text
+    const bool shedding = m_client->isBurstMode();
+
+    if (m_botFilter) {
+        startNs = shedding ? 0 : monotonicNs();
+        const bool bot = m_botFilter->matches(username, displayName, chat);
+        if (!shedding) {
+            m_stats.record(PipelineStats::BotFilter, monotonicNs() - startNs);
+        }
+        if (bot) {
+            return;
+        }
+    }
+
+    FirstChatterEvent event;
+    event.key = key;
+    event.channel = shard->name;
+    event.username = username;
+    event.displayName = displayName;
+    if (!shedding) {
+        event.message = chat.text.toString();
+    }
+    startNs = shedding ? 0 : monotonicNs();
+    // Twitch's first-msg tag also catches chatters from before this channel's index existed
+    event.newEver = shard->tracker.classify(key) == ChatterTracker::Sighting::NewEver
+        || chat.hasFlag(ChatEvent::FirstMessage);
+    if (!shedding) {
+        m_stats.record(PipelineStats::Lifetime, monotonicNs() - startNs);
+    }
+    m_stats.countFirstChatter();
+    event.generation = m_generation;
+    event.receivedNs = m_client->frameReceivedNs();
+
+    // Keep ordering: never overtake events that are already spilled
+    if (!m_pending.empty() || !enqueue(event)) {
+        m_overflowed.fetch_add(1, std::memory_order_relaxed);
+        m_pending.push_back(std::move(event));
+        if (m_pending.size() == 1) {
+            QTimer::singleShot(5, this, &IrcWorker::flushPending);
+        }
+    }
+}
+
+void IrcWorker::onUserNotice(const ChatEvent &notice)
+{
+    // Subs and announcements are not ours to handle; only raids are passed on
+    if (notice.noticeId != u"raid" || !shardFor(notice.channel)) {
+        return;
+    }
+    QString displayName = notice.message->tagValue(u"msg-param-displayName");
+    if (displayName.isEmpty()) {
+        displayName = unescapeIrcTagValue(notice.displayName);
+    }
+    emit raidReceived(notice.channel.toString(), notice.login.toString().toLower(), displayName, notice.count);
+}
+
+bool IrcWorker::enqueue(FirstChatterEvent &event)
+{
+    event.enqueuedNs = monotonicNs();
+    if (!m_queue.tryPush(std::move(event))) {
+        return false;
+    }
+    wakeConsumer();
+    return true;
+}
+
+void IrcWorker::flushPending()
+{
+    while (!m_pending.empty() && enqueue(m_pending.front())) {
+        m_pending.pop_front();
+    }
+    if (!m_pending.empty()) {
+        QTimer::singleShot(5, this, &IrcWorker::flushPending);
+    }
+}
+
+void IrcWorker::wakeConsumer()
+{
+    // One queued wakeup per drain, however many events arrive meanwhile
+    if (!m_wakeupPending.exchange(true, std::memory_order_acq_rel)) {
+        emit firstChattersAvailable();
+    }
+}
+
+void IrcWorker::acknowledgeWakeup()
+{
+    m_wakeupPending.store(false, std::memory_order_release);
+}
+
+bool IrcWorker::popFirstChatter(FirstChatterEvent &event)
+{
+    return m_queue.tryPop(event);
+}
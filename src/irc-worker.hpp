@@ -0,0 +1,139 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "twitch-irc-client.hpp"
+#include "connection-supervisor.hpp"
+#include "bot-filter.hpp"
+#include "irc-replay.hpp"
+#include "chatter-tracker.hpp"
+#include "pipeline-stats.hpp"
+#include "spsc-queue.hpp"
+
+// A deduplicated first-time chatter, handed from the network side to the dock
+struct FirstChatterEvent {
+    quint64 key = 0;         // ChatterKey::forChatter
+    QString channel;         // Lowercase, without '#'
+    QString username;
+    QString displayName;
+    QString message;         // Empty when the chatter arrived during a raid
+    bool newEver = false;    // Never chatted in this channel before
+    quint32 generation = 0;  // Reset generation the event was produced in
+    qint64 receivedNs = 0;   // Monotonic arrival time of the frame carrying the message
+    qint64 enqueuedNs = 0;   // Monotonic timestamp taken just before enqueue
+};
+
+// Owns the Twitch connection, bot filter and per-channel seen-chatter
+// dedup. One connection serves every joined channel. The worker either
+// lives on the dock's thread or is moved to a dedicated network thread; in
+// both cases only first-chatter events cross over to the dock, through a
+// bounded lock-free queue.
+class IrcWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit IrcWorker(QObject *parent = nullptr);
+    ~IrcWorker() override;
+
+    // Consumer side, safe to call from the dock's thread. Call
+    // acknowledgeWakeup() before draining so no wakeup is lost.
+    void acknowledgeWakeup();
+    bool popFirstChatter(FirstChatterEvent &event);
+    size_t queueDepth() const { return m_queue.size(); }
+    size_t queueCapacity() const { return m_queue.capacity(); }
+    quint64 overflowCount() const { return m_overflowed.load(std::memory_order_relaxed); }
+    quint64 commandCount(IrcCommand command) const { return m_client->commandCount(command); }
+    
+    // Raid state and counters; safe from any thread
+    bool isBurstMode() const { return m_client->isBurstMode(); }
+    const BurstDetector &burstDetector() const { return m_client->burstDetector(); }
+    size_t backlogDepth() const { return m_client->backlogDepth(); }
+    size_t peakBacklogDepth() const { return m_client->peakBacklogDepth(); }
+    quint64 shedFrameCount() const { return m_client->shedFrameCount(); }
+
+    static qint64 monotonicNs();
+    
+    // Stage latencies and rates; the dock records its own stages here too
+    PipelineStats &stats() { return m_stats; }
+
+    // Call on the worker's thread, e.g. through QMetaObject::invokeMethod
+    // with a functor. A null filter lets everyone through.
+    void setBotFilter(std::shared_ptr<const BotFilter> filter);
+    
+    // Marks chatters restored from a saved session as already seen. Call on
+    // the worker's thread, like setBotFilter.
+    void seedSeen(const QString &channel, const std::vector<quint64> &keys);
+
+public slots:
+    // Where per-channel lifetime indexes are kept
+    void setStateDirectory(const QString &directory);
+    // Chat server, e.g. a local mock for load tests; empty means Twitch
+    void setServerUrl(const QUrl &url);
+    void connectToTwitch(const QStringList &channels, const QString &username, const QString &oauthToken);
+    void disconnectFromTwitch();
+    // Changes the joined channels without reconnecting
+    void setChannels(const QStringList &channels);
+    // Messages per second that switch to raid handling; 0 never does
+    void setBurstEnterRate(int messagesPerSecond);
+    void resetSeen(quint32 generation);
+    void startCapture(const QString &path);
+    void stopCapture();
+    // Feeds a capture through the normal parse and dedup path, no network.
+    // speed 1.0 is real time, <= 0 as fast as possible.
+    void replayCapture(const QString &path, double speed);
+
+signals:
+    void connected();
+    void disconnected();
+    void connectionError(const QString &error);
+    // Twitch rejected the credentials; the worker stopped reconnecting
+    void authenticationFailed(const QString &notice);
+    void connectionStateChanged(TwitchIrcClient::ConnectionState state);
+    void burstModeChanged(bool bursting);
+    void firstChattersAvailable();
+    void rttMeasured(qint64 rttNs, qint64 smoothedRttNs);
+    void reconnectScheduled(int attempt, int delayMs);
+    void connectionGap(qint64 startedMs, qint64 durationMs, const QString &reason);
+    void replayFinished(quint64 frames, qint64 elapsedNs);
+    // A raid announced in a joined channel; channel and login are lowercase
+    void raidReceived(const QString &channel, const QString &login, const QString &displayName, int viewers);
+
+private slots:
+    void flushPending();
+
+private:
+    // Seen set and lifetime index of one channel; allocates only as it sees chatters
+    struct ChannelShard {
+        QString name;  // Lowercase, without '#'
+        ChatterTracker tracker;
+    };
+
+    // Chat event subscribers, called during dispatch on this thread
+    void onChatMessage(const ChatEvent &message);
+    void onUserNotice(const ChatEvent &notice);
+
+    void updateShards(const QStringList &channels);
+    ChannelShard *shardFor(QStringView channel) const;
+    bool enqueue(FirstChatterEvent &event);
+    void wakeConsumer();
+
+    TwitchIrcClient *m_client;
+    ConnectionSupervisor *m_supervisor;
+    IrcReplayDriver *m_replay;
+    std::vector<std::unique_ptr<ChannelShard>> m_shards;
+    std::unordered_map<quint64, ChannelShard *> m_shardIndex;  // ChatterKey::fromLogin(name)
+    std::shared_ptr<const BotFilter> m_botFilter;
+    SpscQueue<FirstChatterEvent> m_queue;
+    std::deque<FirstChatterEvent> m_pending;  // Producer-only spill when the queue is full
+    std::atomic<bool> m_wakeupPending{false};
+    std::atomic<quint64> m_overflowed{0};
+    quint32 m_generation = 0;
+    QString m_stateDirectory;
+    PipelineStats m_stats;
+};
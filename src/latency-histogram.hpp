@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Log-linear latency histogram in the spirit of HdrHistogram. Values are
+// grouped by power of two, and each group is split into SUB_BUCKETS linear
+// steps, so a bucket's bounds are within 1/SUB_BUCKETS of every value in it
+// from 1 ns up to several minutes. Recording is a single relaxed atomic add,
+// so any thread may record while another takes snapshots.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAGNITUDES = 40;  // Top bucket ends at 2^42 ns, about 73 minutes; longer counts there
+    static constexpr int BUCKETS = MAGNITUDES * SUB_BUCKETS;
+
+    // Plain copy of the counts; subtract two to get a window
+    struct Snapshot {
+        std::array<quint64, BUCKETS> counts{};
+
+        quint64 total() const
+        {
+            quint64 sum = 0;
+            for (quint64 count : counts) {
+                sum += count;
+            }
+            return sum;
+        }
+
+        // Upper bound of the bucket holding the given fraction of values
+        qint64 percentile(double fraction) const
+        {
+            const quint64 count = total();
+            if (count == 0) {
+                return 0;
+            }
+            const quint64 rank = qMax<quint64>(1, static_cast<quint64>(fraction * count + 0.5));
+            quint64 seen = 0;
+            for (int i = 0; i < BUCKETS; ++i) {
+                seen += counts[static_cast<size_t>(i)];
+                if (seen >= rank) {
+                    return upperBound(i);
+                }
+            }
+            return upperBound(BUCKETS - 1);
+        }
+
+        qint64 max() const
+        {
+            for (int i = BUCKETS - 1; i >= 0; --i) {
+                if (counts[static_cast<size_t>(i)] != 0) {
+                    return upperBound(i);
+                }
+            }
+            return 0;
+        }
+
+        Snapshot since(const Snapshot &earlier) const
+        {
+            Snapshot window;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                window.counts[i] = counts[i] - earlier.counts[i];
+            }
+            return window;
+        }
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void record(qint64 ns, quint64 count = 1)
+    {
+        m_counts[static_cast<size_t>(bucketFor(ns))].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot copy;
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            copy.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        }
+        return copy;
+    }
+
+    static int bucketFor(qint64 ns)
+    {
+        if (ns < SUB_BUCKETS) {
+            return ns < 0 ? 0 : static_cast<int>(ns);
+        }
+        const quint64 value = static_cast<quint64>(ns);
+        const int shift = 63 - static_cast<int>(qCountLeadingZeroBits(value)) - SUB_BUCKET_BITS;
+        const int bucket = ((shift + 1) << SUB_BUCKET_BITS) + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return qMin(bucket, BUCKETS - 1);
+    }
+
+    // Largest value that lands in the bucket
+    static qint64 upperBound(int bucket)
+    {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        const int shift = (bucket >> SUB_BUCKET_BITS) - 1;
+        const qint64 lower = static_cast<qint64>(SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << shift;
+        return lower + (qint64(1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<quint64>, BUCKETS> m_counts{};
+};
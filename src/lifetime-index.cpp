@@ -0,0 +1,209 @@
+#include "lifetime-index.hpp"
+#include "chatter-key.hpp"
+#include <cstring>
+
+static const char INDEX_MAGIC[4] = {'F', 'T', 'C', 'L'};
+static const quint32 INDEX_VERSION = 1;
+
+// 512 KiB to start; doubles as the channel's history grows
+static const quint64 INITIAL_CAPACITY = quint64(1) << 16;
+
+// Grow past 70% load to keep linear probe sequences short
+static const quint64 MAX_LOAD_PERCENT = 70;
+
+LifetimeIndex::~LifetimeIndex()
+{
+    close();
+}
+
+bool LifetimeIndex::open(const QString &path)
+{
+    close();
+    m_path = path;
+
+    // Finish a grow() that was interrupted between its two renames
+    const QString oldPath = path + QStringLiteral(".old");
+    if (!QFile::exists(path) && QFile::exists(oldPath)) {
+        QFile::rename(oldPath, path);
+    }
+    QFile::remove(path + QStringLiteral(".grow"));
+
+    if (!QFile::exists(path) && !create(path, INITIAL_CAPACITY)) {
+        return false;
+    }
+    switch (map()) {
+        case MapResult::Mapped:
+            return true;
+        case MapResult::Failed:
+            // Locked or out of address space; the history is still on disk
+            return false;
+        case MapResult::Invalid:
+            break;
+    }
+
+    // Truncated or from an incompatible version; start over
+    QFile::remove(path);
+    return create(path, INITIAL_CAPACITY) && map() == MapResult::Mapped;
+}
+
+void LifetimeIndex::close()
+{
+    if (m_header) {
+        m_file.unmap(reinterpret_cast<uchar *>(m_header));
+    }
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_file.close();
+}
+
+bool LifetimeIndex::contains(quint64 key) const
+{
+    if (!m_slots || key == 0) {
+        return false;
+    }
+    return *findSlot(m_slots, m_header->capacity, key) == key;
+}
+
+bool LifetimeIndex::insert(quint64 key)
+{
+    if (!m_slots || key == 0) {
+        return false;
+    }
+
+    quint64 *slot = findSlot(m_slots, m_header->capacity, key);
+    if (*slot == key) {
+        return false;
+    }
+
+    if ((m_header->count + 1) * 100 > m_header->capacity * MAX_LOAD_PERCENT) {
+        // Keep going in the old table if growing fails, as long as it has room
+        if (!grow() && (!m_slots || m_header->count + 1 >= m_header->capacity)) {
+            return false;
+        }
+        slot = findSlot(m_slots, m_header->capacity, key);
+    }
+
+    *slot = key;
+    m_header->count++;
+    return true;
+}
+
+quint64 LifetimeIndex::size() const
+{
+    return m_header ? m_header->count : 0;
+}
+
+quint64 LifetimeIndex::capacity() const
+{
+    return m_header ? m_header->capacity : 0;
+}
+
+LifetimeIndex::MapResult LifetimeIndex::map()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return MapResult::Failed;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize < qint64(sizeof(Header))) {
+        m_file.close();
+        return MapResult::Invalid;
+    }
+    uchar *data = m_file.map(0, fileSize);
+    if (!data) {
+        m_file.close();
+        return MapResult::Failed;
+    }
+
+    auto *header = reinterpret_cast<Header *>(data);
+    const quint64 capacity = header->capacity;
+    if (std::memcmp(header->magic, INDEX_MAGIC, 4) != 0 ||
+        header->version != INDEX_VERSION ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        fileSize != qint64(sizeof(Header) + capacity * sizeof(quint64))) {
+        m_file.unmap(data);
+        m_file.close();
+        return MapResult::Invalid;
+    }
+
+    m_header = header;
+    m_slots = reinterpret_cast<quint64 *>(data + sizeof(Header));
+    return MapResult::Mapped;
+}
+
+bool LifetimeIndex::grow()
+{
+    const quint64 oldCapacity = m_header->capacity;
+    const quint64 newCapacity = oldCapacity * 2;
+    const QString growPath = m_path + QStringLiteral(".grow");
+    const QString oldPath = m_path + QStringLiteral(".old");
+
+    // Rehash into a new, larger file next to the current one
+    QFile::remove(growPath);
+    if (!create(growPath, newCapacity)) {
+        return false;
+    }
+
+    QFile target(growPath);
+    uchar *data = target.open(QIODevice::ReadWrite) ? target.map(0, target.size()) : nullptr;
+    if (!data) {
+        target.close();
+        QFile::remove(growPath);
+        return false;
+    }
+
+    auto *header = reinterpret_cast<Header *>(data);
+    auto *slots = reinterpret_cast<quint64 *>(data + sizeof(Header));
+    for (quint64 i = 0; i < oldCapacity; ++i) {
+        if (m_slots[i] != 0) {
+            *findSlot(slots, newCapacity, m_slots[i]) = m_slots[i];
+        }
+    }
+    header->count = m_header->count;
+    target.unmap(data);
+    target.close();
+
+    // Swap files; open() finishes the swap if we crash between the renames
+    close();
+    QFile::remove(oldPath);
+    if (!QFile::rename(m_path, oldPath)) {
+        QFile::remove(growPath);
+        map();
+        return false;
+    }
+    if (!QFile::rename(growPath, m_path)) {
+        QFile::rename(oldPath, m_path);
+        map();
+        return false;
+    }
+    QFile::remove(oldPath);
+    return map() == MapResult::Mapped;
+}
+
+bool LifetimeIndex::create(const QString &path, quint64 capacity)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = INDEX_VERSION;
+    header.capacity = capacity;
+
+    // Zeroed slots are empty; the resize is sparse on most filesystems
+    return file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header)) &&
+           file.resize(qint64(sizeof(Header) + capacity * sizeof(quint64)));
+}
+
+quint64 *LifetimeIndex::findSlot(quint64 *slots, quint64 capacity, quint64 key)
+{
+    const quint64 mask = capacity - 1;
+    quint64 index = ChatterKey::mix(key) & mask;
+    while (slots[index] != 0 && slots[index] != key) {
+        index = (index + 1) & mask;
+    }
+    return &slots[index];
+}
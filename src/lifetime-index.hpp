@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+// Persistent set of every chatter ever seen in a channel: an open-addressing
+// hash table of 64-bit chatter keys (see ChatterKey) living in a memory-mapped
+// file. Opening only maps the file, so startup cost does not depend on how
+// many chatters it holds; pages are faulted in as lookups touch them.
+class LifetimeIndex {
+public:
+    LifetimeIndex() = default;
+    ~LifetimeIndex();
+
+    LifetimeIndex(const LifetimeIndex &) = delete;
+    LifetimeIndex &operator=(const LifetimeIndex &) = delete;
+
+    // Maps the index at path, creating an empty one if needed. A file that
+    // is not an index of this version is replaced; one that merely cannot be
+    // opened or mapped right now is left alone and false returned.
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_slots != nullptr; }
+    QString path() const { return m_path; }
+
+    bool contains(quint64 key) const;
+
+    // Returns true if the key was not present before
+    bool insert(quint64 key);
+
+    quint64 size() const;
+    quint64 capacity() const;
+
+private:
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint64 capacity;
+        quint64 count;
+        quint64 reserved;
+    };
+
+    enum class MapResult {
+        Mapped,
+        Invalid,  // Not an index of this version, or truncated
+        Failed    // Could not be opened or mapped; may work later
+    };
+
+    MapResult map();
+    bool grow();
+    static bool create(const QString &path, quint64 capacity);
+    static quint64 *findSlot(quint64 *slots, quint64 capacity, quint64 key);
+
+    QString m_path;
+    QFile m_file;
+    Header *m_header = nullptr;
+    quint64 *m_slots = nullptr;
+};
@@ -0,0 +1,389 @@
+#include "overlay-server.hpp"
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <algorithm>
+
+// One batch per ~60 Hz frame, like the list model's inserts
+static const int FRAME_INTERVAL_MS = 16;
+
+// Batches kept for clients that reconnect; older ones resync by snapshot
+static const size_t HISTORY_BATCHES = 512;
+
+// Anything longer is not a request from a browser source
+static const qint64 MAX_REQUEST_HEADER = 8 * 1024;
+
+static const char OVERLAY_PAGE[] = R"html(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>First-Time Chatters</title>
+<style>
+  body { margin: 0; background: transparent; font: 600 28px/1.3 "Segoe UI", Roboto, sans-serif; color: #efeff1; }
+  ul { list-style: none; margin: 0; padding: 8px; }
+  li { padding: 4px 12px; margin-bottom: 6px; background: rgba(14, 14, 16, 0.75); border-left: 4px solid #9147ff;
+       border-radius: 4px; animation: in 0.3s ease-out; }
+  li.new-ever { color: #bf94ff; }
+  li.greeted { color: #7a7a7d; text-decoration: line-through; border-left-color: #3d3d42; }
+  @keyframes in { from { opacity: 0; transform: translateX(-20px); } }
+</style>
+</head>
+<body>
+<ul id="list"></ul>
+<script>
+// ?channel=name shows one channel, ?limit=N the newest N chatters
+const params = new URLSearchParams(location.search);
+const channel = (params.get("channel") || "").toLowerCase();
+const limit = parseInt(params.get("limit") || "10", 10);
+const list = document.getElementById("list");
+let chatters = [];
+let seq = -1;
+let retryMs = 500;
+
+function render() {
+  list.replaceChildren(...chatters.slice(0, limit).map(c => {
+    const item = document.createElement("li");
+    item.textContent = c.name;
+    item.className = c.greeted ? "greeted" : (c.newEver ? "new-ever" : "");
+    return item;
+  }));
+}
+
+function wanted(event) { return !channel || event.channel === channel; }
+
+function apply(event) {
+  if (event.op === "reset") {
+    chatters = event.channel ? chatters.filter(c => c.channel !== event.channel) : [];
+  } else if (!wanted(event)) {
+    return;
+  } else if (event.op === "added") {
+    chatters.unshift({ id: event.id, channel: event.channel, name: event.name, newEver: event.newEver, greeted: event.greeted });
+    chatters.length = Math.min(chatters.length, 50);
+  } else if (event.op === "greeted") {
+    const chatter = chatters.find(c => c.id === event.id && c.channel === event.channel);
+    if (chatter) chatter.greeted = event.greeted;
+  }
+}
+
+function connect() {
+  const socket = new WebSocket("ws://" + location.host + "/ws" + (seq >= 0 ? "?since=" + seq : ""));
+  socket.onopen = () => { retryMs = 500; };
+  socket.onmessage = message => {
+    const data = JSON.parse(message.data);
+    if (data.type === "snapshot") {
+      chatters = data.chatters.filter(wanted);
+    } else if (data.type === "batch") {
+      data.events.forEach(apply);
+    }
+    seq = data.seq;
+    render();
+  };
+  socket.onclose = () => {
+    setTimeout(connect, retryMs);
+    retryMs = Math.min(retryMs * 2, 10000);
+  };
+}
+
+connect();
+</script>
+</body>
+</html>
+)html";
+
+static QJsonObject chatterJson(const QString &channel, quint64 key, const QString &displayName, bool newEver,
+                               bool greeted)
+{
+    // Keys are 64-bit; JSON numbers would lose precision in the browser
+    return QJsonObject{
+        {QStringLiteral("channel"), channel},
+        {QStringLiteral("id"), QString::number(key)},
+        {QStringLiteral("name"), displayName},
+        {QStringLiteral("newEver"), newEver},
+        {QStringLiteral("greeted"), greeted},
+    };
+}
+
+OverlayServer::OverlayServer(QObject *parent)
+    : QObject(parent)
+    , m_tcpServer(new QTcpServer(this))
+    , m_webSocketServer(new QWebSocketServer(QStringLiteral("First-Time Chatter overlay"),
+                                             QWebSocketServer::NonSecureMode, this))
+    , m_frameTimer(new QTimer(this))
+{
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(FRAME_INTERVAL_MS);
+    connect(m_frameTimer, &QTimer::timeout, this, &OverlayServer::flushBatch);
+    connect(m_tcpServer, &QTcpServer::newConnection, this, &OverlayServer::onTcpConnection);
+    connect(m_webSocketServer, &QWebSocketServer::newConnection, this, &OverlayServer::onWebSocketConnection);
+}
+
+OverlayServer::~OverlayServer()
+{
+    close();
+}
+
+bool OverlayServer::listen(quint16 port)
+{
+    close();
+    return m_tcpServer->listen(QHostAddress::LocalHost, port);
+}
+
+void OverlayServer::close()
+{
+    // Clients that come back after a restart get a snapshot: the batches
+    // they missed are not kept, and changes made while closed are in none
+    if (m_tcpServer->isListening()) {
+        ++m_sequence;
+    }
+    m_frameTimer->stop();
+    for (const Event &event : m_pending) {
+        apply(event);
+    }
+    m_pending.clear();
+    m_history.clear();
+
+    m_tcpServer->close();
+    for (QWebSocket *client : std::as_const(m_clients)) {
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+    }
+    m_clients.clear();
+}
+
+void OverlayServer::chatterAdded(const QString &channel, quint64 key, const QString &displayName, bool newEver,
+                                 bool greeted)
+{
+    Event event{Event::Added, channel};
+    event.key = key;
+    event.displayName = displayName;
+    event.newEver = newEver;
+    event.greeted = greeted;
+    queue(std::move(event));
+}
+
+void OverlayServer::chatterGreeted(const QString &channel, quint64 key, bool greeted)
+{
+    Event event{Event::Greeted, channel};
+    event.key = key;
+    event.greeted = greeted;
+    queue(std::move(event));
+}
+
+void OverlayServer::channelReset(const QString &channel)
+{
+    queue(Event{Event::Reset, channel});
+}
+
+void OverlayServer::queue(Event event)
+{
+    // Nobody to send batches to; keep only the snapshot current for when
+    // the overlay is turned on
+    if (!isListening()) {
+        apply(event);
+        return;
+    }
+    m_pending.push_back(std::move(event));
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+void OverlayServer::apply(const Event &event)
+{
+    switch (event.op) {
+        case Event::Added: {
+            std::deque<Chatter> &latest = m_latest[event.channel];
+            latest.push_front({event.key, event.displayName, event.newEver, event.greeted, ++m_addedCount});
+            if (latest.size() > static_cast<size_t>(SNAPSHOT_LIMIT)) {
+                latest.pop_back();
+            }
+            break;
+        }
+        case Event::Greeted: {
+            auto it = m_latest.find(event.channel);
+            if (it == m_latest.end()) {
+                break;
+            }
+            for (Chatter &chatter : *it) {
+                if (chatter.key == event.key) {
+                    chatter.greeted = event.greeted;
+                    break;
+                }
+            }
+            break;
+        }
+        case Event::Reset:
+            if (event.channel.isEmpty()) {
+                m_latest.clear();
+            } else {
+                m_latest.remove(event.channel);
+            }
+            break;
+    }
+}
+
+void OverlayServer::flushBatch()
+{
+    m_frameTimer->stop();
+    if (m_pending.empty()) {
+        return;
+    }
+
+    // State advances with the batch, so a snapshot always matches its seq
+    QJsonArray events;
+    for (const Event &event : m_pending) {
+        apply(event);
+        QJsonObject json;
+        switch (event.op) {
+            case Event::Added:
+                json = chatterJson(event.channel, event.key, event.displayName, event.newEver, event.greeted);
+                json.insert(QStringLiteral("op"), QStringLiteral("added"));
+                break;
+            case Event::Greeted:
+                json = QJsonObject{
+                    {QStringLiteral("op"), QStringLiteral("greeted")},
+                    {QStringLiteral("channel"), event.channel},
+                    {QStringLiteral("id"), QString::number(event.key)},
+                    {QStringLiteral("greeted"), event.greeted},
+                };
+                break;
+            case Event::Reset:
+                json = QJsonObject{
+                    {QStringLiteral("op"), QStringLiteral("reset")},
+                    {QStringLiteral("channel"), event.channel},
+                };
+                break;
+        }
+        events.append(json);
+    }
+    m_pending.clear();
+
+    ++m_sequence;
+    const QByteArray message = QJsonDocument(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("batch")},
+        {QStringLiteral("seq"), static_cast<qint64>(m_sequence)},
+        {QStringLiteral("events"), events},
+    }).toJson(QJsonDocument::Compact);
+
+    m_history.emplace_back(m_sequence, message);
+    if (m_history.size() > HISTORY_BATCHES) {
+        m_history.pop_front();
+    }
+    m_batchCount++;
+
+    const QString text = QString::fromUtf8(message);
+    for (QWebSocket *client : std::as_const(m_clients)) {
+        client->sendTextMessage(text);
+    }
+}
+
+QByteArray OverlayServer::snapshot() const
+{
+    // Newest first across channels, as the batches would have built it
+    std::vector<std::pair<const QString *, const Chatter *>> all;
+    for (auto it = m_latest.cbegin(); it != m_latest.cend(); ++it) {
+        for (const Chatter &chatter : it.value()) {
+            all.emplace_back(&it.key(), &chatter);
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const auto &a, const auto &b) { return a.second->order > b.second->order; });
+
+    QJsonArray chatters;
+    for (const auto &[channel, chatter] : all) {
+        chatters.append(chatterJson(*channel, chatter->key, chatter->displayName, chatter->newEver, chatter->greeted));
+    }
+    return QJsonDocument(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("snapshot")},
+        {QStringLiteral("seq"), static_cast<qint64>(m_sequence)},
+        {QStringLiteral("chatters"), chatters},
+    }).toJson(QJsonDocument::Compact);
+}
+
+void OverlayServer::onTcpConnection()
+{
+    while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            // Peek, so a WebSocket handshake is still unread when handed over
+            const QByteArray head = socket->peek(MAX_REQUEST_HEADER);
+            if (!head.contains("\r\n\r\n")) {
+                if (head.size() >= MAX_REQUEST_HEADER) {
+                    socket->abort();
+                }
+                return;
+            }
+            if (head.toLower().contains("upgrade: websocket")) {
+                // The QWebSocket owns the socket from here on
+                socket->disconnect();
+                m_webSocketServer->handleConnection(socket);
+            } else {
+                socket->disconnect(this);
+                serveHttp(socket);
+            }
+        });
+    }
+}
+
+void OverlayServer::serveHttp(QTcpSocket *socket)
+{
+    const QByteArray head = socket->readAll();
+    const QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+    const QByteArray path = requestLine.size() >= 2 ? requestLine[1].split('?').first() : QByteArray();
+
+    QByteArray status = "200 OK";
+    QByteArray contentType;
+    QByteArray body;
+    if (requestLine.value(0) != "GET") {
+        status = "405 Method Not Allowed";
+    } else if (path == "/" || path == "/overlay") {
+        contentType = "text/html; charset=utf-8";
+        body = QByteArray(OVERLAY_PAGE);
+    } else if (path == "/snapshot") {
+        contentType = "application/json";
+        body = snapshot();
+    } else {
+        status = "404 Not Found";
+    }
+
+    QByteArray response = "HTTP/1.1 " + status + "\r\n";
+    if (!contentType.isEmpty()) {
+        response += "Content-Type: " + contentType + "\r\n";
+    }
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                "Cache-Control: no-store\r\n"
+                "Connection: close\r\n\r\n" + body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void OverlayServer::onWebSocketConnection()
+{
+    while (QWebSocket *client = m_webSocketServer->nextPendingConnection()) {
+        m_clients.append(client);
+        connect(client, &QWebSocket::disconnected, this, [this, client]() {
+            m_clients.removeOne(client);
+            client->deleteLater();
+        });
+
+        // Resume from the batches kept if the client's seq is still covered;
+        // pending events go out with the next batch either way
+        bool ok = false;
+        const quint64 since = QUrlQuery(client->requestUrl()).queryItemValue(QStringLiteral("since")).toULongLong(&ok);
+        const bool covered = ok && since <= m_sequence &&
+                             (since == m_sequence || (!m_history.empty() && m_history.front().first <= since + 1));
+        if (covered) {
+            m_resumeCount++;
+            for (const auto &[sequence, message] : m_history) {
+                if (sequence > since) {
+                    client->sendTextMessage(QString::fromUtf8(message));
+                }
+            }
+        } else {
+            m_snapshotCount++;
+            client->sendTextMessage(QString::fromUtf8(snapshot()));
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <deque>
+#include <vector>
+
+// Serves first-time chatters to OBS browser sources on localhost. One port
+// answers plain HTTP (the overlay page at /, the current state at
+// /snapshot) and WebSocket upgrades (/ws), which stream what changes.
+//
+// Changes are queued and sent once per frame as a numbered batch of added,
+// greeted and reset events; the latest few chatters per channel form the
+// snapshot a new client starts from. A client that reconnects with
+// ?since=<seq> gets only the batches it missed while they are still kept,
+// and a fresh snapshot otherwise.
+//
+// While not listening, changes only update that snapshot; no batches are
+// built or kept.
+//
+// Needs no Twitch connection: anything can feed it, such as a benchmark.
+class OverlayServer : public QObject {
+    Q_OBJECT
+
+public:
+    // Chatters per channel a new client is sent; an overlay shows a few at most
+    static constexpr int SNAPSHOT_LIMIT = 50;
+
+    explicit OverlayServer(QObject *parent = nullptr);
+    ~OverlayServer() override;
+
+    // Binds 127.0.0.1 only; port 0 picks a free one
+    bool listen(quint16 port);
+    void close();
+    bool isListening() const { return m_tcpServer->isListening(); }
+    quint16 port() const { return m_tcpServer->serverPort(); }
+
+    void chatterAdded(const QString &channel, quint64 key, const QString &displayName, bool newEver, bool greeted);
+    void chatterGreeted(const QString &channel, quint64 key, bool greeted);
+    // An empty channel resets all of them
+    void channelReset(const QString &channel = QString());
+
+    // Sequence number of the last batch sent; snapshots carry it too
+    quint64 sequence() const { return m_sequence; }
+    int clientCount() const { return static_cast<int>(m_clients.size()); }
+    quint64 batchCount() const { return m_batchCount; }
+    quint64 snapshotCount() const { return m_snapshotCount; }
+    quint64 resumeCount() const { return m_resumeCount; }
+
+private slots:
+    void onTcpConnection();
+    void onWebSocketConnection();
+    void flushBatch();
+
+private:
+    struct Event {
+        enum Op { Added, Greeted, Reset };
+        Op op;
+        QString channel;
+        quint64 key = 0;
+        QString displayName;
+        bool newEver = false;
+        bool greeted = false;
+    };
+
+    struct Chatter {
+        quint64 key;
+        QString displayName;
+        bool newEver;
+        bool greeted;
+        quint64 order;  // Arrival across channels, for the snapshot
+    };
+
+    void queue(Event event);
+    void apply(const Event &event);
+    void serveHttp(QTcpSocket *socket);
+    QByteArray snapshot() const;
+
+    QTcpServer *m_tcpServer;
+    QWebSocketServer *m_webSocketServer;
+    QList<QWebSocket *> m_clients;
+    QTimer *m_frameTimer;
+
+    std::vector<Event> m_pending;
+    quint64 m_sequence = 0;
+    std::deque<std::pair<quint64, QByteArray>> m_history;  // Recent batches, oldest first
+
+    // Newest first, at most SNAPSHOT_LIMIT per channel; as of m_sequence
+    QHash<QString, std::deque<Chatter>> m_latest;
+    quint64 m_addedCount = 0;
+
+    quint64 m_batchCount = 0;
+    quint64 m_snapshotCount = 0;
+    quint64 m_resumeCount = 0;
+};
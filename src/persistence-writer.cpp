@@ -0,0 +1,189 @@
+#include "persistence-writer.hpp"
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSettings>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Window after the first request of a burst in which later ones are merged
+static const int COALESCE_MS = 200;
+
+PersistenceWriter::PersistenceWriter(const QString &organization, const QString &application)
+    : m_organization(organization)
+    , m_application(application)
+    , m_thread(new QThread())
+    , m_coalesceTimer(new QTimer(this))
+{
+    m_coalesceTimer->setSingleShot(true);
+    m_coalesceTimer->setInterval(COALESCE_MS);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &PersistenceWriter::writePending);
+
+    // finished is emitted on the thread itself, where the timer lives
+    connect(m_thread, &QThread::finished, this, &PersistenceWriter::threadFinished, Qt::DirectConnection);
+
+    m_thread->setObjectName(QStringLiteral("FirstTimeChatterPersistence"));
+    moveToThread(m_thread);
+    m_thread->start(QThread::LowPriority);
+}
+
+PersistenceWriter::~PersistenceWriter()
+{
+    // Deleted by its own thread after an abandoned shutdown(); the thread
+    // deletes itself
+    if (QThread::currentThread() == m_thread) {
+        return;
+    }
+    if (!m_stopped && !shutdown(1000)) {
+        // Abandoned to the thread, which deletes this object again later.
+        // Only reached if the owner ignored shutdown(); see the class comment.
+        return;
+    }
+    delete m_thread;
+}
+
+void PersistenceWriter::threadFinished()
+{
+    m_coalesceTimer->stop();
+    QMutexLocker locker(&m_mutex);
+    m_stopped = true;
+    if (m_abandoned) {
+        deleteLater();
+        m_thread->deleteLater();
+    }
+}
+
+void PersistenceWriter::saveSettings(const QVariantHash &values)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = values.cbegin(); it != values.cend(); ++it) {
+            m_pendingSettings.insert(it.key(), it.value());
+        }
+        m_pendingRequests++;
+    }
+    requested();
+}
+
+void PersistenceWriter::syncFile(const QString &path)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pendingSyncs.insert(path);
+        m_pendingRequests++;
+    }
+    requested();
+}
+
+void PersistenceWriter::requested()
+{
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+
+    // One queued call per burst, however many requests arrive meanwhile
+    if (!m_scheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &PersistenceWriter::schedule, Qt::QueuedConnection);
+    }
+}
+
+void PersistenceWriter::schedule()
+{
+    m_scheduled.store(false, std::memory_order_release);
+    if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start();
+    }
+}
+
+void PersistenceWriter::writePending()
+{
+    m_coalesceTimer->stop();
+
+    QVariantHash settings;
+    QSet<QString> syncs;
+    quint64 requests = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        settings.swap(m_pendingSettings);
+        syncs.swap(m_pendingSyncs);
+        requests = m_pendingRequests;
+        m_pendingRequests = 0;
+        m_writing = requests > 0;
+    }
+    if (requests == 0) {
+        return;
+    }
+
+    quint64 writes = 0;
+    if (!settings.isEmpty()) {
+        QSettings store(m_organization, m_application);
+        for (auto it = settings.cbegin(); it != settings.cend(); ++it) {
+            if (!it.value().isValid()) {
+                store.remove(it.key());
+            } else {
+                store.setValue(it.key(), it.value());
+            }
+        }
+        store.sync();
+        writes++;
+    }
+
+    // fsync flushes the file's data whichever descriptor it is called on
+    for (const QString &path : std::as_const(syncs)) {
+        QFile file(path);
+        // Never create the file: compaction may have deleted the journal since
+        if (file.open(QIODevice::ReadOnly | QIODevice::ExistingOnly)) {
+#ifdef Q_OS_WIN
+            _commit(file.handle());
+#else
+            ::fsync(file.handle());
+#endif
+        }
+        writes++;
+    }
+
+    m_writes.fetch_add(writes, std::memory_order_relaxed);
+    m_coalesced.fetch_add(requests - writes, std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    m_writing = false;
+    if (isIdle()) {
+        m_idle.wakeAll();
+    }
+}
+
+bool PersistenceWriter::shutdown(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+
+    // Skip the coalescing window and write whatever is pending now
+    QMetaObject::invokeMethod(this, &PersistenceWriter::writePending, Qt::QueuedConnection);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!isIdle()) {
+            if (!m_idle.wait(&m_mutex, deadline)) {
+                break;
+            }
+        }
+    }
+
+    m_thread->quit();
+    if (!m_thread->wait(deadline)) {
+        QMutexLocker locker(&m_mutex);
+        if (!m_stopped) {
+            m_abandoned = true;
+            return false;
+        }
+        // Stopped just now; only the thread's own teardown is left
+    }
+    m_thread->wait();
+
+    // With the thread gone, anything the loop did not get to is written here
+    if (!isIdle()) {
+        writePending();
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVariantHash>
+#include <QWaitCondition>
+#include <atomic>
+
+// Disk work the dock should never wait for: QSettings writes and fsyncs of
+// journal files. Requests are thread-safe and return at once. Requests that
+// arrive within COALESCE_MS of the first one are merged and applied in one
+// go on the writer's own thread, so a reset or a run of greet clicks costs
+// one write. shutdown() flushes what is left with a bounded wait.
+//
+// The writer moves itself to its thread, so it takes no parent; delete it
+// after shutdown() returns true. When shutdown() returns false the thread
+// is stuck in a write and destroying it would abort the process, so the
+// writer must not be touched again: it deletes itself and its thread once
+// the write returns, or is leaked if it never does.
+class PersistenceWriter : public QObject {
+    Q_OBJECT
+
+public:
+    // organization and application name the QSettings store
+    PersistenceWriter(const QString &organization, const QString &application);
+    ~PersistenceWriter() override;
+
+    // Later values for a key replace earlier ones; an invalid QVariant removes it
+    void saveSettings(const QVariantHash &values);
+
+    // fsyncs the file; data written before the call is durable once it runs
+    void syncFile(const QString &path);
+
+    // Writes everything still pending and stops the thread. Returns false
+    // if that took longer than timeoutMs; the rest is then abandoned along
+    // with the writer, see above.
+    bool shutdown(int timeoutMs);
+
+    quint64 requestCount() const { return m_requests.load(std::memory_order_relaxed); }
+    quint64 writeCount() const { return m_writes.load(std::memory_order_relaxed); }
+    // Requests that were folded into a write made for another request
+    quint64 coalescedCount() const { return m_coalesced.load(std::memory_order_relaxed); }
+
+private slots:
+    void schedule();
+    void writePending();
+
+private:
+    void threadFinished();
+    void requested();
+    bool isIdle() const { return m_pendingRequests == 0 && !m_writing; }
+
+    QString m_organization;
+    QString m_application;
+    QThread *m_thread;        // On the heap so a stuck one can outlive the writer's owner
+    QTimer *m_coalesceTimer;  // Lives on m_thread
+
+    QMutex m_mutex;
+    QWaitCondition m_idle;
+    QVariantHash m_pendingSettings;
+    QSet<QString> m_pendingSyncs;
+    quint64 m_pendingRequests = 0;
+    bool m_writing = false;
+    bool m_stopped = false;    // m_thread ran its last event
+    bool m_abandoned = false;  // shutdown() gave up; the thread frees everything
+    std::atomic<bool> m_scheduled{false};
+
+    std::atomic<quint64> m_requests{0};
+    std::atomic<quint64> m_writes{0};
+    std::atomic<quint64> m_coalesced{0};
+};
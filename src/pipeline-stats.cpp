@@ -0,0 +1,61 @@
+#include "pipeline-stats.hpp"
+
+const char *PipelineStats::stageName(Stage stage)
+{
+    switch (stage) {
+        case Receive:    return "receive";
+        case Split:      return "split";
+        case Parse:      return "parse";
+        case Dedup:      return "dedup";
+        case BotFilter:  return "bot filter";
+        case Lifetime:   return "lifetime";
+        case Handoff:    return "hand-off";
+        case Persist:    return "persist";
+        case UiInsert:   return "ui insert";
+        case StageCount: break;
+    }
+    return "?";
+}
+
+PipelineStats::Snapshot PipelineStats::snapshot(qint64 nowNs) const
+{
+    Snapshot copy;
+    copy.takenNs = nowNs;
+    copy.messages = m_messages.load(std::memory_order_relaxed);
+    copy.firstChatters = m_firstChatters.load(std::memory_order_relaxed);
+    for (int i = 0; i < StageCount; ++i) {
+        copy.stages[static_cast<size_t>(i)] = m_stages[static_cast<size_t>(i)].snapshot();
+    }
+    return copy;
+}
+
+// Microseconds with one decimal below 100 µs, whole above
+static QString formatMicros(qint64 ns)
+{
+    const double us = ns / 1000.0;
+    return us < 100 ? QString::number(us, 'f', 1) : QString::number(qRound64(us));
+}
+
+QString PipelineStats::summary(const Snapshot &earlier, const Snapshot &later)
+{
+    const double seconds = qMax<qint64>(1, later.takenNs - earlier.takenNs) / 1e9;
+    QString text = QStringLiteral("%1 msg/s, %2 first chatters/s")
+        .arg(QString::number((later.messages - earlier.messages) / seconds, 'f', 0))
+        .arg(QString::number((later.firstChatters - earlier.firstChatters) / seconds, 'f', 1));
+
+    for (int i = 0; i < StageCount; ++i) {
+        const size_t at = static_cast<size_t>(i);
+        const LatencyHistogram::Snapshot window = later.stages[at].since(earlier.stages[at]);
+        const quint64 count = window.total();
+        if (count == 0) {
+            continue;
+        }
+        text += QStringLiteral("\n%1 p50 %2 p99 %3 max %4 µs (%5)")
+            .arg(QLatin1String(stageName(static_cast<Stage>(i))), -10)
+            .arg(formatMicros(window.percentile(0.5)), 7)
+            .arg(formatMicros(window.percentile(0.99)), 7)
+            .arg(formatMicros(window.max()), 7)
+            .arg(count);
+    }
+    return text;
+}
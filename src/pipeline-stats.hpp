@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QString>
+#include <array>
+#include <atomic>
+#include "latency-histogram.hpp"
+
+// Where time goes between a frame arriving and its chatter's row appearing.
+// Each stage has one lock-free histogram; stages are recorded from the
+// network side or the dock, never both, and snapshots may be taken from any
+// thread. Per-line stages only time one line in SAMPLE_INTERVAL so the
+// instrumentation can stay on in production.
+class PipelineStats {
+public:
+    enum Stage {
+        Receive,    // Frame arrival to line splitting, including capture
+        Split,      // Start of the frame to reaching the line (sampled)
+        Parse,      // Tokenizing one PRIVMSG into a ChatEvent (sampled)
+        Dedup,      // Per-session seen check (sampled)
+        BotFilter,  // Bot rules, first sightings only
+        Lifetime,   // Lifetime index lookup and insert, first sightings only
+        Handoff,    // Lock-free queue to the dock
+        Persist,    // Session append and greeted journal records, on the dock
+        UiInsert,   // Storing a batch of rows and the views' insert, once per batch
+        StageCount
+    };
+
+    static constexpr quint32 SAMPLE_INTERVAL = 8;
+
+    struct Snapshot {
+        qint64 takenNs = 0;
+        quint64 messages = 0;
+        quint64 firstChatters = 0;
+        std::array<LatencyHistogram::Snapshot, StageCount> stages;
+    };
+
+    static const char *stageName(Stage stage);
+
+    void record(Stage stage, qint64 ns, quint64 count = 1) { m_stages[stage].record(ns, count); }
+
+    // Network thread only. True for the lines whose per-line stages are timed.
+    bool sampleLine() { return m_lineCounter++ % SAMPLE_INTERVAL == 0; }
+
+    void countMessage() { m_messages.fetch_add(1, std::memory_order_relaxed); }
+    void countFirstChatter() { m_firstChatters.fetch_add(1, std::memory_order_relaxed); }
+    // Messages counted so far; cheaper than a snapshot when that is all that's needed
+    quint64 messageCount() const { return m_messages.load(std::memory_order_relaxed); }
+
+    Snapshot snapshot(qint64 nowNs) const;
+
+    // Rates and per-stage percentiles between two snapshots of the same
+    // stats, one line per stage that saw traffic
+    static QString summary(const Snapshot &earlier, const Snapshot &later);
+
+private:
+    std::array<LatencyHistogram, StageCount> m_stages;
+    std::atomic<quint64> m_messages{0};
+    std::atomic<quint64> m_firstChatters{0};
+    quint32 m_lineCounter = 0;
+};
@@ -0,0 +1,175 @@
+#include "session-store.hpp"
+#include <QDateTime>
+#include <QDir>
+#include <QtEndian>
+#include <cstring>
+
+static const char SESSION_MAGIC[4] = {'F', 'T', 'C', 'V'};
+static const quint32 SESSION_VERSION = 1;
+
+// Header: magic, version, creation time (ms since epoch)
+static const qsizetype HEADER_SIZE = 16;
+
+// Record: key (8), seen at ms (8), flags (1), display name length (1),
+// login length (1), UTF-8 display name, UTF-8 login, CRC-16 (2). The login
+// is empty when it is just the lowercased display name, as in ChatterRow.
+static const qsizetype RECORD_FIXED_SIZE = 19;
+static const qsizetype RECORD_CRC_SIZE = 2;
+
+static const quint8 FLAG_NEW_EVER = 0x01;
+
+// Rows arrive in bursts during raids; write them a moment later in one go
+static const int WRITE_DELAY_MS = 250;
+
+SessionStore::SessionStore(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_writeTimer(new QTimer(this))
+{
+    m_writeTimer->setSingleShot(true);
+    m_writeTimer->setInterval(WRITE_DELAY_MS);
+    connect(m_writeTimer, &QTimer::timeout, this, &SessionStore::writeBuffered);
+
+    m_writerPool.setMaxThreadCount(1);
+}
+
+SessionStore::~SessionStore()
+{
+    flush();
+}
+
+QByteArray SessionStore::header()
+{
+    QByteArray bytes(SESSION_MAGIC, 4);
+    char field[8];
+    qToLittleEndian(SESSION_VERSION, field);
+    bytes.append(field, 4);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), field);
+    bytes.append(field, 8);
+    return bytes;
+}
+
+QString SessionStore::path() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("session.bin"));
+}
+
+std::vector<ChatterRow> SessionStore::load()
+{
+    std::vector<ChatterRow> rows;
+    QFile file(path());
+    qsizetype validSize = 0;
+
+    if (file.open(QIODevice::ReadOnly) && file.size() >= HEADER_SIZE) {
+        const qsizetype size = static_cast<qsizetype>(file.size());
+        const uchar *data = file.map(0, size);
+        if (data && std::memcmp(data, SESSION_MAGIC, 4) == 0 &&
+            qFromLittleEndian<quint32>(data + 4) == SESSION_VERSION) {
+            // Rough guess that avoids most reallocations for large sessions
+            rows.reserve(static_cast<size_t>(size / (RECORD_FIXED_SIZE + RECORD_CRC_SIZE + 12)));
+
+            qsizetype pos = HEADER_SIZE;
+            while (pos + RECORD_FIXED_SIZE + RECORD_CRC_SIZE <= size) {
+                const uchar *record = data + pos;
+                const qsizetype displayLength = record[17];
+                const qsizetype loginLength = record[18];
+                const qsizetype bodySize = RECORD_FIXED_SIZE + displayLength + loginLength;
+                if (pos + bodySize + RECORD_CRC_SIZE > size ||
+                    qFromLittleEndian<quint16>(record + bodySize) !=
+                        qChecksum(QByteArrayView(reinterpret_cast<const char *>(record), bodySize))) {
+                    break;
+                }
+
+                ChatterRow row;
+                row.key = qFromLittleEndian<quint64>(record);
+                row.seenAtMs = qFromLittleEndian<qint64>(record + 8);
+                row.newEver = (record[16] & FLAG_NEW_EVER) != 0;
+                row.displayName = QString::fromUtf8(reinterpret_cast<const char *>(record + RECORD_FIXED_SIZE), displayLength);
+                row.login = QString::fromUtf8(reinterpret_cast<const char *>(record + RECORD_FIXED_SIZE + displayLength), loginLength);
+                rows.push_back(std::move(row));
+
+                pos += bodySize + RECORD_CRC_SIZE;
+            }
+            validSize = pos;
+        }
+        if (data) {
+            file.unmap(const_cast<uchar *>(data));
+        }
+    }
+    file.close();
+
+    // Cut a torn tail so appends continue from the last good record, or
+    // start a fresh file if there was nothing usable
+    if (validSize > 0) {
+        if (validSize < file.size()) {
+            file.resize(validSize);
+        }
+    } else if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(header());
+        file.close();
+    }
+    return rows;
+}
+
+void SessionStore::append(const ChatterRow &row)
+{
+    const QByteArray displayName = row.displayName.toUtf8().left(0xff);
+    const QByteArray login = row.login.toUtf8().left(0xff);
+
+    const qsizetype start = m_buffer.size();
+    char field[8];
+    qToLittleEndian(row.key, field);
+    m_buffer.append(field, 8);
+    qToLittleEndian(row.seenAtMs, field);
+    m_buffer.append(field, 8);
+    m_buffer.append(static_cast<char>(row.newEver ? FLAG_NEW_EVER : 0));
+    m_buffer.append(static_cast<char>(displayName.size()));
+    m_buffer.append(static_cast<char>(login.size()));
+    m_buffer.append(displayName);
+    m_buffer.append(login);
+    qToLittleEndian(qChecksum(QByteArrayView(m_buffer).sliced(start)), field);
+    m_buffer.append(field, 2);
+
+    if (!m_writeTimer->isActive()) {
+        m_writeTimer->start();
+    }
+}
+
+void SessionStore::clear()
+{
+    m_writeTimer->stop();
+    m_buffer.clear();
+
+    const QString file = path();
+    const QByteArray bytes = header();
+    m_writerPool.start([file, bytes]() {
+        QFile out(file);
+        if (out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            out.write(bytes);
+        }
+    });
+}
+
+void SessionStore::flush()
+{
+    writeBuffered();
+    m_writerPool.waitForDone();
+}
+
+void SessionStore::writeBuffered()
+{
+    m_writeTimer->stop();
+    if (m_buffer.isEmpty()) {
+        return;
+    }
+
+    const QString file = path();
+    QByteArray bytes;
+    bytes.swap(m_buffer);
+    m_writerPool.start([file, bytes]() {
+        QFile out(file);
+        if (out.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            out.write(bytes);
+        }
+    });
+}
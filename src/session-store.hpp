@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <vector>
+#include "chatter-list-model.hpp"
+
+// The current session of one channel: every first-time chatter in the
+// order they arrived, with the time and new-ever flag, so the list and the
+// seen set survive an OBS restart or crash. Greeted flags are not stored
+// here; they come from the GreetedJournal when rows are restored.
+//
+// The file is append-only fixed-header binary. Appends are buffered and
+// written by a background thread a moment later; load() maps the file and
+// decodes it in one pass, stopping at a torn or corrupt tail.
+class SessionStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SessionStore(const QString &directory, QObject *parent = nullptr);
+    ~SessionStore() override;
+
+    // Rows oldest first. Call once before appending.
+    std::vector<ChatterRow> load();
+
+    void append(const ChatterRow &row);
+
+    // Starts a new, empty session
+    void clear();
+
+    // Hands buffered rows to the writer and waits until they are written
+    void flush();
+
+private:
+    void writeBuffered();
+    QString path() const;
+    static QByteArray header();
+
+    QString m_directory;
+    QByteArray m_buffer;
+    QTimer *m_writeTimer;
+    QThreadPool m_writerPool;  // One thread, so writes land in order
+};
@@ -4,6 +4,11 @@
 #include <QFormLayout>
 #include <QLabel>
 #include <QGroupBox>
+#include <QMessageBox>
+#include <QRegularExpression>
+#include "twitch-irc-client.hpp"
+
+static const int DEFAULT_OVERLAY_PORT = 8917;
 
 SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent)
@@ -23,8 +28,9 @@ void SettingsDialog::setupUi()
     auto *connectionLayout = new QFormLayout(connectionGroup);
     
     m_channelEdit = new QLineEdit(this);
-    m_channelEdit->setPlaceholderText(tr("e.g., yourchannelname"));
-    connectionLayout->addRow(tr("Channel:"), m_channelEdit);
+    m_channelEdit->setPlaceholderText(tr("e.g., yourchannelname, partnerchannel"));
+    m_channelEdit->setToolTip(tr("Separate several channels with commas; each gets its own tab"));
+    connectionLayout->addRow(tr("Channels:"), m_channelEdit);
     
     m_usernameEdit = new QLineEdit(this);
     m_usernameEdit->setPlaceholderText(tr("Your Twitch username"));
@@ -39,22 +45,113 @@ void SettingsDialog::setupUi()
     oauthHint->setOpenExternalLinks(true);
     connectionLayout->addRow(QString(), oauthHint);
     
+    m_serverEdit = new QLineEdit(this);
+    m_serverEdit->setPlaceholderText(tr("wss://irc-ws.chat.twitch.tv:443"));
+    m_serverEdit->setToolTip(tr("Leave empty for Twitch. A local test server such as ws://127.0.0.1:6667 can be used for load testing; "
+                                "other servers must be wss:// under twitch.tv."));
+    connectionLayout->addRow(tr("Server:"), m_serverEdit);
+    
     mainLayout->addWidget(connectionGroup);
     
     // Bot filter group
     auto *botGroup = new QGroupBox(tr("Bot Filter"), this);
     auto *botLayout = new QVBoxLayout(botGroup);
     
-    auto *botLabel = new QLabel(tr("Bots to filter (one per line):"), this);
+    auto *botLabel = new QLabel(tr("Bots to filter (one rule per line):"), this);
     botLayout->addWidget(botLabel);
     
     m_botListEdit = new QTextEdit(this);
-    m_botListEdit->setPlaceholderText(tr("nightbot\nstreamElements\nmoobot\n..."));
+    m_botListEdit->setPlaceholderText(tr("nightbot\n*_bot\n/^stream(elements|labs)$/\nbadge:bot\n# comment"));
+    m_botListEdit->setToolTip(tr("name: exact login or display name\n"
+                                 "* and ?: wildcards, e.g. *_bot\n"
+                                 "/regex/ or re:regex: case-insensitive regular expression\n"
+                                 "badge:name: chatters wearing that badge\n"
+                                 "tag:key=value: IRC tag value, wildcards allowed\n"
+                                 "Names also match look-alike spellings such as n1ghtb0t."));
     m_botListEdit->setMinimumHeight(100);
     botLayout->addWidget(m_botListEdit);
     
     mainLayout->addWidget(botGroup);
     
+    // Performance group
+    auto *performanceGroup = new QGroupBox(tr("Performance"), this);
+    auto *performanceLayout = new QVBoxLayout(performanceGroup);
+    
+    m_threadedNetworkCheck = new QCheckBox(tr("Run chat connection on a dedicated thread"), this);
+    m_threadedNetworkCheck->setToolTip(tr("Keeps reading chat and answering PINGs while the OBS UI is busy. Applies after restarting OBS."));
+    performanceLayout->addWidget(m_threadedNetworkCheck);
+    
+    m_captureTrafficCheck = new QCheckBox(tr("Record chat traffic for replay"), this);
+    m_captureTrafficCheck->setToolTip(tr("Writes every received frame with its arrival time to a capture file in the plugin's config folder, for reproducing problems with irc-replay."));
+    performanceLayout->addWidget(m_captureTrafficCheck);
+    
+    m_eventLogCheck = new QCheckBox(tr("Log chatter activity to a file"), this);
+    m_eventLogCheck->setToolTip(tr("Writes first chats with their message, greets and resets as JSON lines to logs/chatter-events.jsonl in the plugin's config folder. "
+                                   "The file is rotated at 8 MiB and the last four old files are kept."));
+    performanceLayout->addWidget(m_eventLogCheck);
+    
+    mainLayout->addWidget(performanceGroup);
+    
+    // Overlay group
+    auto *overlayGroup = new QGroupBox(tr("Overlay"), this);
+    auto *overlayLayout = new QFormLayout(overlayGroup);
+    
+    m_overlayCheck = new QCheckBox(tr("Serve a browser-source overlay on this computer"), this);
+    m_overlayCheck->setToolTip(tr("Add a Browser source with the URL http://127.0.0.1:<port>/ to show the latest first-time chatters on stream. "
+                                  "Append ?channel=name to show one channel, &limit=N to show N chatters."));
+    overlayLayout->addRow(m_overlayCheck);
+    
+    m_overlayPortSpin = new QSpinBox(this);
+    m_overlayPortSpin->setRange(1024, 65535);
+    m_overlayPortSpin->setValue(DEFAULT_OVERLAY_PORT);
+    m_overlayPortSpin->setEnabled(false);
+    overlayLayout->addRow(tr("Port:"), m_overlayPortSpin);
+    connect(m_overlayCheck, &QCheckBox::toggled, m_overlayPortSpin, &QWidget::setEnabled);
+    
+    mainLayout->addWidget(overlayGroup);
+    
+    // Text source group
+    auto *textGroup = new QGroupBox(tr("Text Source"), this);
+    auto *textLayout = new QFormLayout(textGroup);
+    
+    m_textSourceCombo = new QComboBox(this);
+    m_textSourceCombo->addItem(tr("(none)"), QString());
+    m_textSourceCombo->setToolTip(tr("Writes the latest first-time chatters, one per line, into this Text source. "
+                                     "It is updated at most a few times per second."));
+    textLayout->addRow(tr("Source:"), m_textSourceCombo);
+    
+    m_textLinesSpin = new QSpinBox(this);
+    m_textLinesSpin->setRange(1, 20);
+    m_textLinesSpin->setValue(5);
+    textLayout->addRow(tr("Lines:"), m_textLinesSpin);
+    
+    mainLayout->addWidget(textGroup);
+    
+    // Automatic reset group
+    auto *resetGroup = new QGroupBox(tr("Automatic Reset"), this);
+    auto *resetLayout = new QFormLayout(resetGroup);
+    
+    m_resetStreamCheck = new QCheckBox(tr("When streaming starts"), this);
+    resetLayout->addRow(m_resetStreamCheck);
+    
+    m_resetTimeCheck = new QCheckBox(tr("Every day at"), this);
+    m_resetTimeEdit = new QTimeEdit(QTime(5, 0), this);
+    m_resetTimeEdit->setDisplayFormat(QStringLiteral("HH:mm"));
+    m_resetTimeEdit->setEnabled(false);
+    resetLayout->addRow(m_resetTimeCheck, m_resetTimeEdit);
+    connect(m_resetTimeCheck, &QCheckBox::toggled, m_resetTimeEdit, &QWidget::setEnabled);
+    
+    m_resetIdleCheck = new QCheckBox(tr("After hours without chat"), this);
+    m_resetIdleCheck->setToolTip(tr("Also applies when OBS was closed for that long after the last chatter."));
+    m_resetIdleSpin = new QSpinBox(this);
+    m_resetIdleSpin->setRange(1, 72);
+    m_resetIdleSpin->setValue(8);
+    m_resetIdleSpin->setEnabled(false);
+    resetLayout->addRow(m_resetIdleCheck, m_resetIdleSpin);
+    connect(m_resetIdleCheck, &QCheckBox::toggled, m_resetIdleSpin, &QWidget::setEnabled);
+    
+    mainLayout->addWidget(resetGroup);
+    
     // Buttons
     auto *buttonLayout = new QHBoxLayout();
     buttonLayout->addStretch();
@@ -77,9 +174,9 @@ void SettingsDialog::applyDarkTheme()
         "QDialog { background-color: #18181b; color: #efeff1; }"
         "QGroupBox { color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; margin-top: 8px; padding-top: 8px; }"
         "QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px; }"
-        "QLineEdit, QTextEdit { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; padding: 4px; }"
-        "QLineEdit:focus, QTextEdit:focus { border-color: #9147ff; }"
-        "QLabel { color: #efeff1; }"
+        "QLineEdit, QTextEdit, QSpinBox, QComboBox, QTimeEdit { background-color: #0e0e10; color: #efeff1; border: 1px solid #3d3d42; border-radius: 4px; padding: 4px; }"
+        "QLineEdit:focus, QTextEdit:focus, QSpinBox:focus, QComboBox:focus, QTimeEdit:focus { border-color: #9147ff; }"
+        "QLabel, QCheckBox { color: #efeff1; }"
         "QLabel a { color: #9147ff; }"
         "QPushButton { background-color: #9147ff; color: #ffffff; border: none; border-radius: 4px; padding: 8px 16px; }"
         "QPushButton:hover { background-color: #772ce8; }"
@@ -89,17 +186,42 @@ void SettingsDialog::applyDarkTheme()
 
 void SettingsDialog::onAccept()
 {
+    const QString server = serverUrl();
+    if (!server.isEmpty()) {
+        const QUrl url(server);
+        if (!url.isValid() || (url.scheme() != QLatin1String("ws") && url.scheme() != QLatin1String("wss"))) {
+            QMessageBox::warning(this, tr("Invalid Server"), tr("The server must be a ws:// or wss:// URL."));
+            return;
+        }
+        if (!TwitchIrcClient::mayReceiveToken(url)) {
+            QMessageBox::warning(this, tr("Server Not Trusted"),
+                tr("Your OAuth token is only sent to wss:// servers under twitch.tv or to a server on this "
+                   "computer. Use a Twitch server, or leave the field empty."));
+            return;
+        }
+    }
     accept();
 }
 
-QString SettingsDialog::channel() const
+QStringList SettingsDialog::channels() const
 {
-    return m_channelEdit->text().trimmed();
+    static const QRegularExpression separators(QStringLiteral("[,\\s]+"));
+    return m_channelEdit->text().split(separators, Qt::SkipEmptyParts);
 }
 
-void SettingsDialog::setChannel(const QString &channel)
+void SettingsDialog::setChannels(const QStringList &channels)
 {
-    m_channelEdit->setText(channel);
+    m_channelEdit->setText(channels.join(QStringLiteral(", ")));
+}
+
+QString SettingsDialog::serverUrl() const
+{
+    return m_serverEdit->text().trimmed();
+}
+
+void SettingsDialog::setServerUrl(const QString &url)
+{
+    m_serverEdit->setText(url);
 }
 
 QString SettingsDialog::username() const
@@ -133,7 +255,7 @@ QStringList SettingsDialog::botList() const
     QString text = m_botListEdit->toPlainText();
     QStringList lines = text.split('\n', Qt::SkipEmptyParts);
     for (const QString &line : lines) {
-        QString trimmed = line.trimmed().toLower();
+        QString trimmed = line.trimmed();
         if (!trimmed.isEmpty()) {
             bots.append(trimmed);
         }
@@ -145,3 +267,113 @@ void SettingsDialog::setBotList(const QStringList &bots)
 {
     m_botListEdit->setPlainText(bots.join('\n'));
 }
+
+bool SettingsDialog::threadedNetwork() const
+{
+    return m_threadedNetworkCheck->isChecked();
+}
+
+void SettingsDialog::setThreadedNetwork(bool enabled)
+{
+    m_threadedNetworkCheck->setChecked(enabled);
+}
+
+bool SettingsDialog::captureTraffic() const
+{
+    return m_captureTrafficCheck->isChecked();
+}
+
+void SettingsDialog::setCaptureTraffic(bool enabled)
+{
+    m_captureTrafficCheck->setChecked(enabled);
+}
+
+bool SettingsDialog::eventLog() const
+{
+    return m_eventLogCheck->isChecked();
+}
+
+void SettingsDialog::setEventLog(bool enabled)
+{
+    m_eventLogCheck->setChecked(enabled);
+}
+
+int SettingsDialog::overlayPort() const
+{
+    return m_overlayCheck->isChecked() ? m_overlayPortSpin->value() : 0;
+}
+
+void SettingsDialog::setOverlayPort(int port)
+{
+    m_overlayCheck->setChecked(port > 0);
+    if (port > 0) {
+        m_overlayPortSpin->setValue(port);
+    }
+}
+
+QString SettingsDialog::textSource() const
+{
+    return m_textSourceCombo->currentData().toString();
+}
+
+void SettingsDialog::setTextSources(const QStringList &sources, const QString &current)
+{
+    while (m_textSourceCombo->count() > 1) {
+        m_textSourceCombo->removeItem(1);
+    }
+    for (const QString &source : sources) {
+        m_textSourceCombo->addItem(source, source);
+    }
+    // Keep a configured source that is missing from this scene collection
+    if (!current.isEmpty() && !sources.contains(current)) {
+        m_textSourceCombo->addItem(tr("%1 (missing)").arg(current), current);
+    }
+    const int index = m_textSourceCombo->findData(current);
+    m_textSourceCombo->setCurrentIndex(index < 0 ? 0 : index);
+}
+
+int SettingsDialog::textSourceLines() const
+{
+    return m_textLinesSpin->value();
+}
+
+void SettingsDialog::setTextSourceLines(int lines)
+{
+    m_textLinesSpin->setValue(lines);
+}
+
+bool SettingsDialog::resetOnStreamStart() const
+{
+    return m_resetStreamCheck->isChecked();
+}
+
+void SettingsDialog::setResetOnStreamStart(bool enabled)
+{
+    m_resetStreamCheck->setChecked(enabled);
+}
+
+QTime SettingsDialog::resetTime() const
+{
+    return m_resetTimeCheck->isChecked() ? m_resetTimeEdit->time() : QTime();
+}
+
+void SettingsDialog::setResetTime(const QTime &time)
+{
+    m_resetTimeCheck->setChecked(time.isValid());
+    if (time.isValid()) {
+        m_resetTimeEdit->setTime(time);
+    }
+}
+
+int SettingsDialog::resetIdleHours() const
+{
+    return m_resetIdleCheck->isChecked() ? m_resetIdleSpin->value() : 0;
+}
+
+void SettingsDialog::setResetIdleHours(int hours)
+{
+    m_resetIdleCheck->setChecked(hours > 0);
+    if (hours > 0) {
+        m_resetIdleSpin->setValue(hours);
+    }
+}
@@ -3,7 +3,12 @@
 #include <QDialog>
 #include <QLineEdit>
 #include <QTextEdit>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QPushButton>
+#include <QSpinBox>
+#include <QTime>
+#include <QTimeEdit>
 
 class SettingsDialog : public QDialog {
     Q_OBJECT
@@ -12,8 +17,13 @@ public:
     explicit SettingsDialog(QWidget *parent = nullptr);
     ~SettingsDialog() override = default;
 
-    QString channel() const;
-    void setChannel(const QString &channel);
+    // Comma- or space-separated in the edit, joined over one connection
+    QStringList channels() const;
+    void setChannels(const QStringList &channels);
+
+    // Empty for the default Twitch endpoint
+    QString serverUrl() const;
+    void setServerUrl(const QString &url);
 
     QString username() const;
     void setUsername(const QString &username);
@@ -24,6 +34,33 @@ public:
     QStringList botList() const;
     void setBotList(const QStringList &bots);
 
+    bool threadedNetwork() const;
+    void setThreadedNetwork(bool enabled);
+
+    bool captureTraffic() const;
+    void setCaptureTraffic(bool enabled);
+
+    bool eventLog() const;
+    void setEventLog(bool enabled);
+
+    // 0 when the overlay is off
+    int overlayPort() const;
+    void setOverlayPort(int port);
+
+    // Empty when no text source is driven; sources lists the choices
+    QString textSource() const;
+    void setTextSources(const QStringList &sources, const QString &current);
+    int textSourceLines() const;
+    void setTextSourceLines(int lines);
+
+    // Automatic resets; an invalid time and 0 hours are off
+    bool resetOnStreamStart() const;
+    void setResetOnStreamStart(bool enabled);
+    QTime resetTime() const;
+    void setResetTime(const QTime &time);
+    int resetIdleHours() const;
+    void setResetIdleHours(int hours);
+
 private slots:
     void onAccept();
 
@@ -34,7 +71,20 @@ private:
     QLineEdit *m_channelEdit;
     QLineEdit *m_usernameEdit;
     QLineEdit *m_oauthEdit;
+    QLineEdit *m_serverEdit;
     QTextEdit *m_botListEdit;
+    QCheckBox *m_threadedNetworkCheck;
+    QCheckBox *m_captureTrafficCheck;
+    QCheckBox *m_eventLogCheck;
+    QCheckBox *m_overlayCheck;
+    QSpinBox *m_overlayPortSpin;
+    QComboBox *m_textSourceCombo;
+    QSpinBox *m_textLinesSpin;
+    QCheckBox *m_resetStreamCheck;
+    QCheckBox *m_resetTimeCheck;
+    QTimeEdit *m_resetTimeEdit;
+    QCheckBox *m_resetIdleCheck;
+    QSpinBox *m_resetIdleSpin;
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
 };
@@ -0,0 +1,141 @@
+#include "text-source-output.hpp"
+#include <QDeadlineTimer>
+#include <obs-module.h>
+#include <cstring>
+
+// At most four source updates a second, so a raid costs a handful of
+// re-renders of the text instead of one per chatter
+static const qint64 MIN_UPDATE_INTERVAL_NS = 250ll * 1000 * 1000;
+
+static const int DEFAULT_LINE_COUNT = 5;
+
+static const int MISSING_SOURCE_RETRY_MS = 1000;
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+TextSourceOutput::TextSourceOutput(QObject *parent)
+    : QObject(parent)
+    , m_lineCount(DEFAULT_LINE_COUNT)
+    , m_updateTimer(new QTimer(this))
+{
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &TextSourceOutput::flush);
+}
+
+void TextSourceOutput::setSourceName(const QString &name)
+{
+    if (name == m_sourceName) {
+        return;
+    }
+    m_sourceName = name;
+
+    // The new source has not been written yet
+    m_sourceWritten = false;
+    if (!m_sourceName.isEmpty()) {
+        requestUpdate();
+    }
+}
+
+void TextSourceOutput::setLineCount(int lines)
+{
+    m_lineCount = qMax(1, lines);
+    while (m_latest.size() > static_cast<size_t>(m_lineCount)) {
+        m_latest.pop_back();
+    }
+    requestUpdate();
+}
+
+void TextSourceOutput::chatterAdded(const QString &displayName)
+{
+    m_latest.push_front(displayName);
+    if (m_latest.size() > static_cast<size_t>(m_lineCount)) {
+        m_latest.pop_back();
+    }
+    requestUpdate();
+}
+
+void TextSourceOutput::clear()
+{
+    m_latest.clear();
+    requestUpdate();
+}
+
+void TextSourceOutput::refresh()
+{
+    if (m_sourceName.isEmpty()) {
+        return;
+    }
+    m_sourceWritten = false;
+    m_updateTimer->stop();
+    flush();
+}
+
+void TextSourceOutput::requestUpdate()
+{
+    if (m_sourceName.isEmpty()) {
+        return;
+    }
+    m_requests++;
+
+    // Later changes ride along with the update already scheduled
+    if (m_updateTimer->isActive()) {
+        return;
+    }
+    const qint64 waitNs = m_lastUpdateNs + MIN_UPDATE_INTERVAL_NS - nowNs();
+    m_updateTimer->start(waitNs > 0 ? static_cast<int>(waitNs / 1000000) + 1 : 0);
+}
+
+void TextSourceOutput::flush()
+{
+    if (m_sourceName.isEmpty()) {
+        return;
+    }
+
+    QString text;
+    for (const QString &name : m_latest) {
+        if (!text.isEmpty()) {
+            text += QLatin1Char('\n');
+        }
+        text += name;
+    }
+    if (m_sourceWritten && text == m_lastText) {
+        m_unchanged++;
+        return;
+    }
+
+    obs_source_t *source = obs_get_source_by_name(m_sourceName.toUtf8().constData());
+    if (!source) {
+        // Not loaded yet, or renamed or deleted; keep looking
+        m_updateTimer->start(MISSING_SOURCE_RETRY_MS);
+        return;
+    }
+    obs_data_t *settings = obs_data_create();
+    obs_data_set_string(settings, "text", text.toUtf8().constData());
+    obs_source_update(source, settings);
+    obs_data_release(settings);
+    obs_source_release(source);
+
+    m_lastText = text;
+    m_sourceWritten = true;
+    m_lastUpdateNs = nowNs();
+    m_updates++;
+}
+
+QStringList TextSourceOutput::availableSources()
+{
+    QStringList names;
+    obs_enum_sources(
+        [](void *param, obs_source_t *source) {
+            const char *id = obs_source_get_unversioned_id(source);
+            if (id && (std::strcmp(id, "text_ft2_source") == 0 || std::strcmp(id, "text_gdiplus") == 0)) {
+                static_cast<QStringList *>(param)->append(QString::fromUtf8(obs_source_get_name(source)));
+            }
+            return true;
+        },
+        &names);
+    names.sort(Qt::CaseInsensitive);
+    return names;
+}
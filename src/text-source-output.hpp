@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <deque>
+
+// Shows the latest first-time chatters, one per line, in an OBS text source
+// the user picked (Text (FreeType 2) or Text (GDI+)). Changes are coalesced:
+// the source is updated at most four times a second however
+// many chatters arrive, and not at all if the text came out the same.
+// A source that does not exist yet, as while OBS loads a scene collection,
+// is looked for again every second until it turns up.
+class TextSourceOutput : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TextSourceOutput(QObject *parent = nullptr);
+
+    // Empty turns the output off
+    void setSourceName(const QString &name);
+    const QString &sourceName() const { return m_sourceName; }
+    void setLineCount(int lines);
+
+    void chatterAdded(const QString &displayName);
+    void clear();
+
+    // Writes the text again now, such as after a scene collection loaded
+    void refresh();
+
+    // Names of the scene's text sources, for the settings dialog
+    static QStringList availableSources();
+
+    quint64 requestCount() const { return m_requests; }
+    quint64 updateCount() const { return m_updates; }
+    quint64 unchangedCount() const { return m_unchanged; }
+
+private slots:
+    void flush();
+
+private:
+    void requestUpdate();
+
+    QString m_sourceName;
+    int m_lineCount;
+    std::deque<QString> m_latest;  // Newest first, at most m_lineCount
+    QString m_lastText;            // As last sent to the source
+    bool m_sourceWritten = false;
+    QTimer *m_updateTimer;
+    qint64 m_lastUpdateNs = 0;
+
+    quint64 m_requests = 0;
+    quint64 m_updates = 0;
+    quint64 m_unchanged = 0;
+};
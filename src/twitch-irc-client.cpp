@@ -1,19 +1,40 @@
 #include "twitch-irc-client.hpp"
+#include "irc-message.hpp"
+#include <QDeadlineTimer>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QVarLengthArray>
+#include <algorithm>
+
+// Parsing yields to the event loop after this long while bursting, so the
+// thread it runs on keeps painting and answering input through a raid
+static const qint64 BACKLOG_SLICE_NS = 4 * 1000 * 1000;
+
+static qint64 nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+// Lines that must not wait behind a raid's backlog: a late PONG looks like
+// a stalled connection
+static bool isUrgent(IrcCommand command)
+{
+    return command == IrcCommand::Ping || command == IrcCommand::Pong || command == IrcCommand::Reconnect;
+}
 
 TwitchIrcClient::TwitchIrcClient(QObject *parent)
     : QObject(parent)
     , m_webSocket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this))
-    , m_pingTimer(new QTimer(this))
+    , m_serverUrl(defaultServerUrl())
     , m_connectionState(ConnectionState::Disconnected)
+    , m_burstTimer(new QTimer(this))
 {
+    m_burstTimer->setInterval(BurstDetector::WINDOW_MS);
+    connect(m_burstTimer, &QTimer::timeout, this, &TwitchIrcClient::pollBurst);
     connect(m_webSocket, &QWebSocket::connected, this, &TwitchIrcClient::onConnected);
     connect(m_webSocket, &QWebSocket::disconnected, this, &TwitchIrcClient::onDisconnected);
     connect(m_webSocket, &QWebSocket::textMessageReceived, this, &TwitchIrcClient::onTextMessageReceived);
     connect(m_webSocket, &QWebSocket::errorOccurred, this, &TwitchIrcClient::onError);
-    connect(m_pingTimer, &QTimer::timeout, this, &TwitchIrcClient::sendPing);
-    
-    // Ping every 4 minutes to keep connection alive
-    m_pingTimer->setInterval(4 * 60 * 1000);
 }
 
 TwitchIrcClient::~TwitchIrcClient()
@@ -21,29 +42,97 @@ TwitchIrcClient::~TwitchIrcClient()
     disconnect();
 }
 
-void TwitchIrcClient::connectToTwitch(const QString &channel, const QString &username, const QString &oauthToken)
+QUrl TwitchIrcClient::defaultServerUrl()
+{
+    return QUrl(QStringLiteral("wss://irc-ws.chat.twitch.tv:443"));
+}
+
+void TwitchIrcClient::setServerUrl(const QUrl &url)
+{
+    m_serverUrl = url.isValid() && !url.isEmpty() ? url : defaultServerUrl();
+}
+
+bool TwitchIrcClient::mayReceiveToken(const QUrl &url)
+{
+    const QString host = url.host().toLower();
+    if (host == QLatin1String("localhost") || QHostAddress(host).isLoopback()) {
+        return true;
+    }
+    return url.scheme() == QLatin1String("wss")
+        && (host == QLatin1String("twitch.tv") || host.endsWith(QLatin1String(".twitch.tv")));
+}
+
+static QStringList normalizedChannels(const QStringList &channels)
+{
+    QStringList result;
+    for (const QString &channel : channels) {
+        QString name = channel.trimmed().toLower();
+        if (!name.startsWith('#')) {
+            name.prepend('#');
+        }
+        if (name.size() > 1 && !result.contains(name)) {
+            result.append(name);
+        }
+    }
+    return result;
+}
+
+void TwitchIrcClient::connectToTwitch(const QStringList &channels, const QString &username, const QString &oauthToken)
 {
     if (m_connectionState == ConnectionState::Connected || m_connectionState == ConnectionState::Connecting) {
         disconnect();
     }
     
-    m_channel = channel.toLower();
-    if (!m_channel.startsWith('#')) {
-        m_channel.prepend('#');
-    }
+    m_channels = normalizedChannels(channels);
     m_username = username.toLower();
     m_oauthToken = oauthToken;
     
     setConnectionState(ConnectionState::Connecting);
-    m_webSocket->open(QUrl(QStringLiteral("wss://irc-ws.chat.twitch.tv:443")));
+    m_webSocket->open(m_serverUrl);
+}
+
+void TwitchIrcClient::reconnect()
+{
+    connectToTwitch(m_channels, m_username, m_oauthToken);
+}
+
+void TwitchIrcClient::abortConnection()
+{
+    m_webSocket->abort();
+}
+
+void TwitchIrcClient::setChannels(const QStringList &channels)
+{
+    const QStringList next = normalizedChannels(channels);
+    if (m_connectionState == ConnectionState::Connected) {
+        QStringList joined;
+        QStringList parted;
+        for (const QString &channel : next) {
+            if (!m_channels.contains(channel)) {
+                joined.append(channel);
+            }
+        }
+        for (const QString &channel : std::as_const(m_channels)) {
+            if (!next.contains(channel)) {
+                parted.append(channel);
+            }
+        }
+        if (!parted.isEmpty()) {
+            sendRaw(QStringLiteral("PART %1").arg(parted.join(',')));
+        }
+        if (!joined.isEmpty()) {
+            sendRaw(QStringLiteral("JOIN %1").arg(joined.join(',')));
+        }
+    }
+    m_channels = next;
 }
 
 void TwitchIrcClient::disconnect()
 {
-    m_pingTimer->stop();
     if (m_webSocket->state() != QAbstractSocket::UnconnectedState) {
         m_webSocket->close();
     }
+    clearBacklog();
     setConnectionState(ConnectionState::Disconnected);
 }
 
@@ -57,34 +146,202 @@ void TwitchIrcClient::setConnectionState(ConnectionState state)
 
 void TwitchIrcClient::onConnected()
 {
+    m_welcomed = false;
+    
     // Request capabilities for tags and commands
     sendRaw(QStringLiteral("CAP REQ :twitch.tv/tags twitch.tv/commands"));
     
-    // Authenticate
-    sendRaw(QStringLiteral("PASS oauth:%1").arg(m_oauthToken));
-    sendRaw(QStringLiteral("NICK %1").arg(m_username));
+    // Authenticate, unless the token would cross the network in the clear
+    if (mayReceiveToken(m_serverUrl)) {
+        sendRaw(QStringLiteral("PASS oauth:%1").arg(m_oauthToken));
+        sendRaw(QStringLiteral("NICK %1").arg(m_username));
+    } else {
+        sendRaw(QStringLiteral("NICK justinfan%1").arg(QRandomGenerator::global()->bounded(10000, 100000)));
+    }
     
-    // Join channel
-    sendRaw(QStringLiteral("JOIN %1").arg(m_channel));
+    // Join every channel with one command
+    if (!m_channels.isEmpty()) {
+        sendRaw(QStringLiteral("JOIN %1").arg(m_channels.join(',')));
+    }
     
     setConnectionState(ConnectionState::Connected);
-    m_pingTimer->start();
     emit connected();
 }
 
 void TwitchIrcClient::onDisconnected()
 {
-    m_pingTimer->stop();
+    clearBacklog();
     setConnectionState(ConnectionState::Disconnected);
     emit disconnected();
 }
 
 void TwitchIrcClient::onTextMessageReceived(const QString &message)
 {
-    QStringList lines = message.split(QStringLiteral("\r\n"), Qt::SkipEmptyParts);
-    for (const QString &line : lines) {
-        parseIrcMessage(line);
+    m_frameReceivedNs = nowNs();
+    if (m_capture.isOpen()) {
+        m_capture.write(m_frameReceivedNs, message);
+    }
+    
+    // Frames that arrive during a raid wait their turn and keep their arrival time
+    if (m_burst.isBursting() || !m_backlog.empty()) {
+        backlogFrame(message);
+        return;
     }
+    processFrame(message);
+}
+
+void TwitchIrcClient::backlogFrame(const QString &frame)
+{
+    QVarLengthArray<QStringView, 2> urgent;
+    bool chat = false;
+    forEachIrcLine(frame, [&](QStringView line) {
+        const IrcCommand command = ircCommandOf(ircCommandToken(line));
+        if (isUrgent(command)) {
+            urgent.append(line);
+        } else if (command == IrcCommand::Privmsg) {
+            chat = true;
+        }
+    });
+
+    BacklogFrame entry{m_frameReceivedNs, urgent.isEmpty() ? frame : QString(), chat};
+    if (!urgent.isEmpty()) {
+        forEachIrcLine(frame, [&entry](QStringView line) {
+            if (!isUrgent(ircCommandOf(ircCommandToken(line)))) {
+                entry.text += line;
+                entry.text += QLatin1String("\r\n");
+            }
+        });
+    }
+
+    if (!entry.text.isEmpty()) {
+        bool keep = true;
+        if (m_backlog.size() >= MAX_BACKLOG_FRAMES) {
+            // First chatters come from chat; anything else is shed before it
+            m_shedFrames.fetch_add(1, std::memory_order_relaxed);
+            if (!entry.chat) {
+                keep = false;
+            } else {
+                auto victim = m_backlog.begin();
+                if (m_backlogOtherFrames > 0) {
+                    victim = std::find_if(m_backlog.begin(), m_backlog.end(),
+                                          [](const BacklogFrame &queued) { return !queued.chat; });
+                    m_backlogOtherFrames--;
+                }
+                m_backlog.erase(victim);
+            }
+        }
+        if (keep) {
+            m_backlogOtherFrames += entry.chat ? 0 : 1;
+            m_backlog.push_back(std::move(entry));
+            setBacklogDepth(m_backlog.size());
+            if (!m_drainScheduled) {
+                m_drainScheduled = true;
+                QTimer::singleShot(0, this, &TwitchIrcClient::drainBacklog);
+            }
+        }
+    }
+
+    // After queueing, so a RECONNECT that drops the socket also drops the rest
+    for (QStringView line : urgent) {
+        dispatchLine(line);
+    }
+}
+
+void TwitchIrcClient::clearBacklog()
+{
+    // Frames from a closed socket must not reach the next connection's state
+    m_backlog.clear();
+    m_backlogOtherFrames = 0;
+    setBacklogDepth(0);
+    if (m_burst.reset()) {
+        burstModeToggled();
+    }
+}
+
+void TwitchIrcClient::drainBacklog()
+{
+    m_drainScheduled = false;
+    const qint64 sliceEndNs = nowNs() + BACKLOG_SLICE_NS;
+    while (!m_backlog.empty()) {
+        const BacklogFrame frame = std::move(m_backlog.front());
+        m_backlog.pop_front();
+        m_backlogOtherFrames -= frame.chat ? 0 : 1;
+        m_frameReceivedNs = frame.receivedNs;
+        processFrame(frame.text);
+        if (nowNs() >= sliceEndNs) {
+            break;
+        }
+    }
+    setBacklogDepth(m_backlog.size());
+    
+    // The rest goes after whatever else the event loop has waiting
+    if (!m_backlog.empty() && !m_drainScheduled) {
+        m_drainScheduled = true;
+        QTimer::singleShot(0, this, &TwitchIrcClient::drainBacklog);
+    }
+}
+
+void TwitchIrcClient::setBacklogDepth(size_t depth)
+{
+    m_backlogDepth.store(depth, std::memory_order_relaxed);
+    if (depth > m_peakBacklogDepth.load(std::memory_order_relaxed)) {
+        m_peakBacklogDepth.store(depth, std::memory_order_relaxed);
+    }
+}
+
+void TwitchIrcClient::setBurstEnterRate(int messagesPerSecond)
+{
+    const bool wasBursting = m_burst.isBursting();
+    m_burst.setEnterRate(messagesPerSecond);
+    if (m_burst.isBursting() != wasBursting) {
+        burstModeToggled();
+    }
+}
+
+void TwitchIrcClient::pollBurst()
+{
+    if (m_burst.poll(nowNs())) {
+        burstModeToggled();
+    }
+}
+
+void TwitchIrcClient::burstModeToggled()
+{
+    if (m_burst.isBursting()) {
+        m_burstTimer->start();
+    } else {
+        m_burstTimer->stop();
+    }
+    emit burstModeChanged(m_burst.isBursting());
+}
+
+void TwitchIrcClient::injectFrame(const QString &frame)
+{
+    m_frameReceivedNs = nowNs();
+    processFrame(frame);
+}
+
+void TwitchIrcClient::processFrame(QStringView frame)
+{
+    if (m_stats) {
+        m_frameStartNs = nowNs();
+        m_stats->record(PipelineStats::Receive, m_frameStartNs - m_frameReceivedNs);
+    }
+    
+    // Frames may carry several lines; walk them in place instead of splitting
+    forEachIrcLine(frame, [this](QStringView line) {
+        dispatchLine(line);
+    });
+}
+
+bool TwitchIrcClient::startCapture(const QString &path)
+{
+    return m_capture.open(path);
+}
+
+void TwitchIrcClient::stopCapture()
+{
+    m_capture.close();
 }
 
 void TwitchIrcClient::onError(QAbstractSocket::SocketError error)
@@ -95,103 +352,141 @@ void TwitchIrcClient::onError(QAbstractSocket::SocketError error)
     emit connectionError(m_lastError);
 }
 
-void TwitchIrcClient::sendPing()
+void TwitchIrcClient::sendPing(const QString &token)
 {
-    sendRaw(QStringLiteral("PING :tmi.twitch.tv"));
+    sendRaw(QStringLiteral("PING :%1").arg(token));
 }
 
 void TwitchIrcClient::sendRaw(const QString &message)
 {
+    // Replayed frames may ask for a PONG while there is no connection
+    if (m_webSocket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
     m_webSocket->sendTextMessage(message);
 }
 
-void TwitchIrcClient::parseIrcMessage(const QString &rawMessage)
+void TwitchIrcClient::dispatchLine(QStringView line)
 {
-    // Handle PING from server
-    if (rawMessage.startsWith(QStringLiteral("PING"))) {
-        sendRaw(QStringLiteral("PONG :tmi.twitch.tv"));
+    // Most lines in a busy channel are state and notice traffic; find the
+    // command first and only parse the lines something handles
+    const QStringView token = ircCommandToken(line);
+    const IrcCommand command = ircCommandOf(token);
+
+    // Only this thread writes, so a plain load and store is enough
+    std::atomic<quint64> &count = m_commandCounts[static_cast<size_t>(command)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    switch (command) {
+        case IrcCommand::Privmsg:
+            if (m_burst.countMessage(m_frameReceivedNs)) {
+                burstModeToggled();
+            }
+            // Timing samples are the first thing a raid sheds
+            m_lineTimed = m_stats && !m_burst.isBursting() && m_stats->sampleLine();
+            handleChatEvent(ChatEvent::Kind::Message, line);
+            m_lineTimed = false;
+            break;
+        case IrcCommand::Usernotice:
+            handleChatEvent(ChatEvent::Kind::UserNotice, line);
+            break;
+        case IrcCommand::Clearchat:
+            handleChatEvent(ChatEvent::Kind::ClearChat, line);
+            break;
+        case IrcCommand::Clearmsg:
+            handleChatEvent(ChatEvent::Kind::ClearMessage, line);
+            break;
+        case IrcCommand::Ping:
+            handlePing(line);
+            break;
+        case IrcCommand::Pong:
+            handlePong(line);
+            break;
+        case IrcCommand::Reconnect:
+            emit reconnectRequested();
+            break;
+        case IrcCommand::Numeric:
+            if (!m_welcomed && token == u"001") {
+                m_welcomed = true;
+                emit welcomed();
+            }
+            break;
+        case IrcCommand::Notice:
+            // Only a login failure matters, and it arrives before the welcome
+            if (!m_welcomed) {
+                handleNotice(line);
+            }
+            break;
+        default:
+            // Counted, otherwise dropped
+            break;
+    }
+}
+
+void TwitchIrcClient::handleChatEvent(ChatEvent::Kind kind, QStringView line)
+{
+    // Lines of a kind nobody subscribed to are only counted, and so is
+    // everything but chat during a raid
+    const bool bursting = m_burst.isBursting();
+    if (!m_chatEvents.wants(kind) || (bursting && kind != ChatEvent::Kind::Message)) {
         return;
     }
+    const qint64 startNs = m_lineTimed ? nowNs() : 0;
     
-    // Parse IRCv3 message with tags
+    // Parse IRCv3 message with tags into views over the frame
     // Format: @tags :prefix COMMAND params :trailing
-    
-    QString tags;
-    QString prefix;
-    QString command;
-    QString params;
-    QString trailing;
-    
-    QString msg = rawMessage;
-    
-    // Extract tags if present
-    if (msg.startsWith('@')) {
-        int spaceIndex = msg.indexOf(' ');
-        if (spaceIndex != -1) {
-            tags = msg.mid(1, spaceIndex - 1);
-            msg = msg.mid(spaceIndex + 1);
-        }
+    IrcMessageView msg;
+    if (!msg.parse(line)) {
+        return;
     }
-    
-    // Extract prefix if present
-    if (msg.startsWith(':')) {
-        int spaceIndex = msg.indexOf(' ');
-        if (spaceIndex != -1) {
-            prefix = msg.mid(1, spaceIndex - 1);
-            msg = msg.mid(spaceIndex + 1);
-        }
+    // During a raid most senders are repeats; locate only who sent it
+    ChatEvent event;
+    if (bursting) {
+        event.parseSender(msg);
+    } else {
+        event.parse(kind, msg);
     }
     
-    // Extract command and params
-    int trailingIndex = msg.indexOf(QStringLiteral(" :"));
-    if (trailingIndex != -1) {
-        trailing = msg.mid(trailingIndex + 2);
-        msg = msg.left(trailingIndex);
+    if (m_lineTimed) {
+        m_stats->record(PipelineStats::Split, startNs - m_frameStartNs);
+        m_stats->record(PipelineStats::Parse, nowNs() - startNs);
     }
     
-    QStringList parts = msg.split(' ', Qt::SkipEmptyParts);
-    if (!parts.isEmpty()) {
-        command = parts.takeFirst();
-        params = parts.join(' ');
+    // Subscribers copy out only the fields they need
+    if (kind == ChatEvent::Kind::Message && event.login.isEmpty()) {
+        return;
     }
-    
-    // Handle PRIVMSG
-    if (command == QStringLiteral("PRIVMSG")) {
-        QString username;
-        QString displayName;
-        
-        // Parse tags for display-name
-        if (!tags.isEmpty()) {
-            QStringList tagList = tags.split(';');
-            for (const QString &tag : tagList) {
-                int eqIndex = tag.indexOf('=');
-                if (eqIndex != -1) {
-                    QString key = tag.left(eqIndex);
-                    QString value = tag.mid(eqIndex + 1);
-                    if (key == QStringLiteral("display-name")) {
-                        displayName = value;
-                    }
-                }
-            }
-        }
-        
-        // Extract username from prefix (nick!user@host)
-        if (!prefix.isEmpty()) {
-            int exclamIndex = prefix.indexOf('!');
-            if (exclamIndex != -1) {
-                username = prefix.left(exclamIndex);
-            } else {
-                username = prefix;
-            }
-        }
-        
-        // If display-name is empty, use username
-        if (displayName.isEmpty()) {
-            displayName = username;
-        }
-        
-        if (!username.isEmpty()) {
-            emit messageReceived(username.toLower(), displayName, trailing);
-        }
+    m_chatEvents.dispatch(event);
+}
+
+void TwitchIrcClient::handlePing(QStringView line)
+{
+    Q_UNUSED(line)
+    sendRaw(QStringLiteral("PONG :tmi.twitch.tv"));
+}
+
+void TwitchIrcClient::handleNotice(QStringView line)
+{
+    // :tmi.twitch.tv NOTICE * :Login authentication failed
+    // :tmi.twitch.tv NOTICE * :Improperly formatted auth
+    IrcMessageView msg;
+    if (!msg.parse(line)) {
+        return;
+    }
+    if (!msg.trailing.contains(u"authentication failed", Qt::CaseInsensitive) &&
+        !msg.trailing.contains(u"formatted auth", Qt::CaseInsensitive)) {
+        return;
+    }
+    m_lastError = msg.trailing.toString();
+    setConnectionState(ConnectionState::Error);
+    emit authenticationFailed(m_lastError);
+}
+
+void TwitchIrcClient::handlePong(QStringView line)
+{
+    // :tmi.twitch.tv PONG tmi.twitch.tv :token
+    IrcMessageView msg;
+    if (msg.parse(line)) {
+        emit pongReceived(msg.trailing.toString());
     }
 }
@@ -2,8 +2,20 @@
 
 #include <QObject>
 #include <QWebSocket>
-#include <QTimer>
+#include <QUrl>
 #include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <utility>
+#include "burst-detector.hpp"
+#include "chat-event.hpp"
+#include "irc-message.hpp"
+#include "irc-capture.hpp"
+#include "pipeline-stats.hpp"
 
 class TwitchIrcClient : public QObject {
     Q_OBJECT
@@ -15,40 +27,142 @@ public:
         Connected,
         Error
     };
+    Q_ENUM(ConnectionState)
 
     explicit TwitchIrcClient(QObject *parent = nullptr);
     ~TwitchIrcClient() override;
 
-    void connectToTwitch(const QString &channel, const QString &username, const QString &oauthToken);
+    static QUrl defaultServerUrl();
+
+    // Takes effect on the next connect; an empty URL restores the default
+    void setServerUrl(const QUrl &url);
+    // The OAuth token is only sent to Twitch over TLS or to a server on this
+    // machine; other servers get an anonymous, read-only login
+    static bool mayReceiveToken(const QUrl &url);
+    QUrl serverUrl() const { return m_serverUrl; }
+
+    // All channels share one connection; names may be given with or without '#'
+    void connectToTwitch(const QStringList &channels, const QString &username, const QString &oauthToken);
     void disconnect();
     
+    // Opens a new connection with the last channels and credentials
+    void reconnect();
+    // Drops the socket at once, e.g. when it stalled; disconnected() follows
+    void abortConnection();
+    
+    // The server answers with PONG carrying the same token
+    void sendPing(const QString &token);
+    
+    // JOINs and PARTs the difference when connected, otherwise just records it
+    void setChannels(const QStringList &channels);
+    
+    // Records every received frame with its arrival time until stopped
+    bool startCapture(const QString &path);
+    void stopCapture();
+    bool isCapturing() const { return m_capture.isOpen(); }
+    
+    // Parses a frame as if it had arrived on the socket; used for replay
+    void injectFrame(const QString &frame);
+    
+    // PRIVMSG, USERNOTICE, CLEARCHAT and CLEARMSG lines go to the
+    // subscribers of their kind, on this client's thread. Subscribe before
+    // connecting.
+    ChatEventDispatcher &chatEvents() { return m_chatEvents; }
+    
+    // Monotonic arrival time of the frame currently being parsed
+    qint64 frameReceivedNs() const { return m_frameReceivedNs; }
+    
+    // Stage timings go here when set; the stats must outlive the client
+    void setStats(PipelineStats *stats) { m_stats = stats; }
+    // True while dispatching a line whose per-line stages are being timed
+    bool isLineTimed() const { return m_lineTimed; }
+    
+    // Lines received per command since construction; safe from any thread
+    quint64 commandCount(IrcCommand command) const
+    {
+        return m_commandCounts[static_cast<size_t>(command)].load(std::memory_order_relaxed);
+    }
+    
+    // Raid handling: above the enter rate, frames are queued and parsed in
+    // short slices per event-loop iteration, and only what first-chatter
+    // detection needs is done. PING, PONG and RECONNECT skip the queue, and
+    // past MAX_BACKLOG_FRAMES frames without chat are shed first. 0 turns it
+    // off. State and counters are safe from any thread.
+    static constexpr size_t MAX_BACKLOG_FRAMES = 50000;
+    void setBurstEnterRate(int messagesPerSecond);
+    const BurstDetector &burstDetector() const { return m_burst; }
+    bool isBurstMode() const { return m_burst.isBursting(); }
+    size_t backlogDepth() const { return m_backlogDepth.load(std::memory_order_relaxed); }
+    size_t peakBacklogDepth() const { return m_peakBacklogDepth.load(std::memory_order_relaxed); }
+    quint64 shedFrameCount() const { return m_shedFrames.load(std::memory_order_relaxed); }
+    
     ConnectionState connectionState() const { return m_connectionState; }
     QString lastError() const { return m_lastError; }
 
 signals:
+    // The socket is open; the login has not been accepted yet
     void connected();
+    // 001 welcome: the server accepted the login
+    void welcomed();
+    // Twitch rejected the token or account; it closes the socket next, and
+    // retrying with the same credentials is pointless
+    void authenticationFailed(const QString &notice);
     void disconnected();
-    void messageReceived(const QString &username, const QString &displayName, const QString &message);
+    void pongReceived(const QString &token);
+    // Twitch asks clients to reconnect before restarting a server
+    void reconnectRequested();
     void connectionError(const QString &error);
     void connectionStateChanged(ConnectionState state);
+    void burstModeChanged(bool bursting);
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onTextMessageReceived(const QString &message);
     void onError(QAbstractSocket::SocketError error);
-    void sendPing();
+    void drainBacklog();
+    void pollBurst();
 
 private:
     void setConnectionState(ConnectionState state);
-    void parseIrcMessage(const QString &rawMessage);
+    void processFrame(QStringView frame);
+    void dispatchLine(QStringView line);
+    void handleChatEvent(ChatEvent::Kind kind, QStringView line);
+    void handlePing(QStringView line);
+    void handlePong(QStringView line);
+    void handleNotice(QStringView line);
     void sendRaw(const QString &message);
+    void burstModeToggled();
+    void backlogFrame(const QString &frame);
+    void clearBacklog();
+    void setBacklogDepth(size_t depth);
 
     QWebSocket *m_webSocket;
-    QTimer *m_pingTimer;
-    QString m_channel;
+    QUrl m_serverUrl;
+    QStringList m_channels;  // Lowercase, with '#'
     QString m_username;
     QString m_oauthToken;
     ConnectionState m_connectionState;
+    bool m_welcomed = false;  // 001 seen on the current socket
     QString m_lastError;
+    IrcCaptureWriter m_capture;
+    ChatEventDispatcher m_chatEvents;
+    qint64 m_frameReceivedNs = 0;
+    qint64 m_frameStartNs = 0;
+    PipelineStats *m_stats = nullptr;
+    bool m_lineTimed = false;
+    BurstDetector m_burst;
+    QTimer *m_burstTimer;                             // Ends a burst once chat goes quiet
+    struct BacklogFrame {
+        qint64 receivedNs;
+        QString text;
+        bool chat;  // Has a PRIVMSG; the others are shed first
+    };
+    std::deque<BacklogFrame> m_backlog;  // While bursting, oldest first
+    size_t m_backlogOtherFrames = 0;     // Frames in the backlog without chat
+    bool m_drainScheduled = false;
+    std::atomic<size_t> m_backlogDepth{0};
+    std::atomic<size_t> m_peakBacklogDepth{0};
+    std::atomic<quint64> m_shedFrames{0};
+    std::array<std::atomic<quint64>, IrcCommandCount> m_commandCounts{};
 };
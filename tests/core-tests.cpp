@@ -0,0 +1,434 @@
+// Unit tests for ftc-core: the parts whose mistakes would not show up as a
+// slow benchmark but as a wrong list. Run through ctest or directly:
+//
+//   core-tests [-v2] [testFunction...]
+
+#include "bot-filter.hpp"
+#include "chat-event.hpp"
+#include "chatter-key.hpp"
+#include "chatter-name-index.hpp"
+#include "chatter-registry.hpp"
+#include "chatter-tracker.hpp"
+#include "flat-id-set.hpp"
+#include "greeted-journal.hpp"
+#include "irc-message.hpp"
+#include "lifetime-index.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+class CoreTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parsesTaggedPrivmsg();
+    void parsesLinesWithoutTagsOrPrefix();
+    void rejectsMalformedLines();
+    void unescapesTagValues();
+    void looksUpCommands();
+
+    void botFilterKeepsRegexMeaning();
+    void botFilterFoldsOnlyLookAlikes();
+    void botFilterMatchesEventBadgesAndTags();
+
+    void flatIdSetMatchesReference();
+    void trackerDedupsAndRemembersLifetime();
+    void lifetimeIndexReplacesOnlyBadFiles();
+
+    void journalReplaysAfterCompaction();
+
+    void nameIndexMatchesPrefixes();
+    void registryTrimsAndClears();
+};
+
+void CoreTests::parsesTaggedPrivmsg()
+{
+    const QString line = QStringLiteral(
+        "@badges=subscriber/12;display-name=Foo\\sBar;user-id=12345 "
+        ":foo!foo@foo.tmi.twitch.tv PRIVMSG #channel :hello there :)");
+
+    IrcMessageView msg;
+    QVERIFY(msg.parse(line));
+    QCOMPARE(msg.command, QStringView(u"PRIVMSG"));
+    QCOMPARE(msg.prefix, QStringView(u"foo!foo@foo.tmi.twitch.tv"));
+    QCOMPARE(msg.nick(), QStringView(u"foo"));
+    QCOMPARE(msg.params, QStringView(u"#channel"));
+    QCOMPARE(msg.trailing, QStringView(u"hello there :)"));
+    QCOMPARE(msg.tag(u"user-id"), QStringView(u"12345"));
+    QCOMPARE(msg.tag(u"display-name"), QStringView(u"Foo\\sBar"));
+    QCOMPARE(msg.tagValue(u"display-name"), QStringLiteral("Foo Bar"));
+
+    // A key that is a prefix of another must not match it
+    QVERIFY(msg.tag(u"user").isNull());
+    QVERIFY(msg.tag(u"color").isNull());
+}
+
+void CoreTests::parsesLinesWithoutTagsOrPrefix()
+{
+    IrcMessageView msg;
+    QVERIFY(msg.parse(u"PING :tmi.twitch.tv"));
+    QCOMPARE(msg.command, QStringView(u"PING"));
+    QVERIFY(msg.tags.isEmpty());
+    QVERIFY(msg.prefix.isEmpty());
+    QCOMPARE(msg.trailing, QStringView(u"tmi.twitch.tv"));
+
+    QVERIFY(msg.parse(u":tmi.twitch.tv 001 justinfan1 :Welcome, GLHF!"));
+    QCOMPARE(msg.command, QStringView(u"001"));
+    QCOMPARE(msg.params, QStringView(u"justinfan1"));
+    QCOMPARE(msg.trailing, QStringView(u"Welcome, GLHF!"));
+
+    QVERIFY(msg.parse(u":foo!foo@foo.tmi.twitch.tv JOIN #channel"));
+    QCOMPARE(msg.params, QStringView(u"#channel"));
+    QVERIFY(msg.trailing.isEmpty());
+}
+
+void CoreTests::rejectsMalformedLines()
+{
+    IrcMessageView msg;
+    QVERIFY(!msg.parse(u""));
+    QVERIFY(!msg.parse(u"@tags-without-anything-else"));
+    QVERIFY(!msg.parse(u":prefix-only"));
+}
+
+void CoreTests::unescapesTagValues()
+{
+    QCOMPARE(unescapeIrcTagValue(u"plain"), QStringLiteral("plain"));
+    QCOMPARE(unescapeIrcTagValue(u"a\\sb"), QStringLiteral("a b"));
+    QCOMPARE(unescapeIrcTagValue(u"semi\\:colon"), QStringLiteral("semi;colon"));
+    QCOMPARE(unescapeIrcTagValue(u"back\\\\slash"), QStringLiteral("back\\slash"));
+    QCOMPARE(unescapeIrcTagValue(u"line\\r\\n"), QStringLiteral("line\r\n"));
+    QCOMPARE(unescapeIrcTagValue(u"trailing\\"), QStringLiteral("trailing"));
+}
+
+void CoreTests::looksUpCommands()
+{
+    const struct {
+        const char16_t *line;
+        IrcCommand command;
+    } cases[] = {
+        {u"@a=b :foo!foo@foo PRIVMSG #c :hi", IrcCommand::Privmsg},
+        {u"PING :tmi.twitch.tv", IrcCommand::Ping},
+        {u":tmi.twitch.tv PONG tmi.twitch.tv :token", IrcCommand::Pong},
+        {u"@msg-id=raid :tmi.twitch.tv USERNOTICE #c", IrcCommand::Usernotice},
+        {u":tmi.twitch.tv CLEARCHAT #c :foo", IrcCommand::Clearchat},
+        {u":tmi.twitch.tv CLEARMSG #c :bye", IrcCommand::Clearmsg},
+        {u":tmi.twitch.tv NOTICE * :Login authentication failed", IrcCommand::Notice},
+        {u":tmi.twitch.tv RECONNECT", IrcCommand::Reconnect},
+        {u":tmi.twitch.tv 001 justinfan1 :Welcome", IrcCommand::Numeric},
+        {u":tmi.twitch.tv CAP * ACK :twitch.tv/tags", IrcCommand::Cap},
+        {u":foo!foo@foo JOIN #c", IrcCommand::Join},
+        {u":tmi.twitch.tv SOMETHINGNEW #c", IrcCommand::Other},
+    };
+    for (const auto &c : cases) {
+        const QStringView line(c.line);
+        QCOMPARE(ircCommandOf(ircCommandToken(line)), c.command);
+
+        // The shortcut must agree with a full parse
+        IrcMessageView msg;
+        QVERIFY(msg.parse(line));
+        QCOMPARE(ircCommandToken(line), msg.command);
+    }
+    QVERIFY(ircCommandToken(u"@only-tags").isEmpty());
+}
+
+void CoreTests::botFilterKeepsRegexMeaning()
+{
+    QStringList errors;
+    const auto filter = BotFilter::compile({
+        QStringLiteral("/^spam$/"),
+        QStringLiteral("/(.)\\1{3}/"),  // Four of a kind; \1 must still be its own group
+        QStringLiteral("/^(?<p>x)y\\k<p>$/"),
+        QStringLiteral("re:^zzz"),
+    }, &errors);
+    QVERIFY2(errors.isEmpty(), qPrintable(errors.join(QLatin1Char('\n'))));
+    QCOMPARE(filter->ruleCount(), 4);
+
+    // Anchors bind to their own rule, not to the neighbouring branch
+    QVERIFY(filter->matchesName(QStringLiteral("spam"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("spammer"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("nospam"), QString()));
+
+    QVERIFY(filter->matchesName(QStringLiteral("heeeey"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("abcdefg"), QString()));
+    QVERIFY(filter->matchesName(QStringLiteral("xyx"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("xyz"), QString()));
+    QVERIFY(filter->matchesName(QStringLiteral("zzzebra"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("ordinary_viewer"), QString()));
+}
+
+void CoreTests::botFilterFoldsOnlyLookAlikes()
+{
+    const auto filter = BotFilter::compile({QStringLiteral("nightbot"), QStringLiteral("lilbot")});
+
+    // Digit and Cyrillic disguises still match
+    QVERIFY(filter->matchesName(QStringLiteral("n1ghtb0t"), QString()));
+    QVERIFY(filter->matchesName(QStringLiteral("someone"), QStringLiteral("Nіghtbot")));
+
+    // Real logins that differ by a letter do not
+    QVERIFY(!filter->matchesName(QStringLiteral("nighlbot"), QString()));
+    QVERIFY(!filter->matchesName(QStringLiteral("iiibot"), QString()));
+    QVERIFY(filter->matchesName(QStringLiteral("lilbot"), QString()));
+}
+
+void CoreTests::botFilterMatchesEventBadgesAndTags()
+{
+    const auto filter = BotFilter::compile({QStringLiteral("badge:bot-badge"), QStringLiteral("tag:client-nonce=spam*")});
+    const QString login = QStringLiteral("someone");
+
+    const auto check = [&](const QString &line) {
+        IrcMessageView message;
+        if (!message.parse(line)) {
+            return false;
+        }
+        ChatEvent event;
+        event.parse(ChatEvent::Kind::Message, message);
+        return filter->matches(login, login, event);
+    };
+    QVERIFY(check(QStringLiteral("@badges=subscriber/12,bot-badge/1 :someone!someone@someone.tmi.twitch.tv PRIVMSG #c :hi")));
+    QVERIFY(!check(QStringLiteral("@badges=bot-badgeish/1 :someone!someone@someone.tmi.twitch.tv PRIVMSG #c :hi")));
+    QVERIFY(check(QStringLiteral("@client-nonce=spam42 :someone!someone@someone.tmi.twitch.tv PRIVMSG #c :hi")));
+    QVERIFY(!check(QStringLiteral("@client-nonce=ham :someone!someone@someone.tmi.twitch.tv PRIVMSG #c :hi")));
+}
+
+void CoreTests::flatIdSetMatchesReference()
+{
+    // Random inserts and removals, checked against std::unordered_set; the
+    // narrow key range forces long probe runs and backward shifts
+    std::mt19937_64 random(42);
+    FlatIdSet set;
+    std::unordered_set<quint64> reference;
+    for (int i = 0; i < 200000; ++i) {
+        const quint64 key = 1 + random() % 5000;
+        if (random() % 3 == 0) {
+            QCOMPARE(set.remove(key), reference.erase(key) == 1);
+        } else {
+            QCOMPARE(set.insert(key), reference.insert(key).second);
+        }
+    }
+    QCOMPARE(set.size(), reference.size());
+    for (quint64 key = 1; key <= 5000; ++key) {
+        QCOMPARE(set.contains(key), reference.count(key) == 1);
+    }
+
+    // 0 marks empty slots and is never a member
+    QVERIFY(!set.insert(0));
+    QVERIFY(!set.contains(0));
+
+    set.clear();
+    QCOMPARE(set.size(), size_t(0));
+    QVERIFY(!set.contains(1));
+}
+
+void CoreTests::trackerDedupsAndRemembersLifetime()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = QDir(directory.path()).filePath(QStringLiteral("lifetime.idx"));
+    const quint64 alice = ChatterKey::forChatter(1001, u"alice");
+    const quint64 bob = ChatterKey::forChatter(1002, u"bob");
+
+    {
+        ChatterTracker tracker;
+        QVERIFY(tracker.openLifetimeIndex(path));
+        QVERIFY(tracker.markSeen(alice));
+        QVERIFY(!tracker.markSeen(alice));
+        QCOMPARE(tracker.classify(alice), ChatterTracker::Sighting::NewEver);
+
+        // A reset forgets the session, not the lifetime index
+        tracker.reset();
+        QCOMPARE(tracker.seenCount(), size_t(0));
+        QVERIFY(tracker.markSeen(alice));
+        QCOMPARE(tracker.classify(alice), ChatterTracker::Sighting::Returning);
+
+        tracker.restoreSeen({bob});
+        QVERIFY(!tracker.markSeen(bob));
+    }
+
+    // The index survives a restart
+    ChatterTracker tracker;
+    QVERIFY(tracker.openLifetimeIndex(path));
+    QVERIFY(tracker.markSeen(alice));
+    QCOMPARE(tracker.classify(alice), ChatterTracker::Sighting::Returning);
+    QVERIFY(tracker.markSeen(bob));
+    QCOMPARE(tracker.classify(bob), ChatterTracker::Sighting::NewEver);
+}
+
+void CoreTests::lifetimeIndexReplacesOnlyBadFiles()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = QDir(directory.path()).filePath(QStringLiteral("lifetime.idx"));
+
+    {
+        LifetimeIndex index;
+        QVERIFY(index.open(path));
+        QVERIFY(index.insert(42));
+    }
+    const qint64 validSize = QFileInfo(path).size();
+
+    // A valid file is kept as it is
+    {
+        LifetimeIndex index;
+        QVERIFY(index.open(path));
+        QVERIFY(index.contains(42));
+    }
+
+    // One that cannot be opened right now is left alone, not recreated
+    QFile::setPermissions(path, QFileDevice::ReadOwner);
+    QFile probe(path);
+    if (!probe.open(QIODevice::ReadWrite)) {
+        LifetimeIndex index;
+        QVERIFY(!index.open(path));
+        QVERIFY(!index.isOpen());
+        QCOMPARE(QFileInfo(path).size(), validSize);
+    }
+    probe.close();
+    QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    {
+        LifetimeIndex index;
+        QVERIFY(index.open(path));
+        QVERIFY(index.contains(42));
+    }
+
+    // Truncated, and then not an index at all: both start over empty
+    QVERIFY(QFile::resize(path, 10));
+    {
+        LifetimeIndex index;
+        QVERIFY(index.open(path));
+        QCOMPARE(index.size(), quint64(0));
+        QVERIFY(!index.contains(42));
+        QVERIFY(index.insert(42));
+    }
+    {
+        QFile foreign(path);
+        QVERIFY(foreign.open(QIODevice::ReadWrite));
+        QVERIFY(foreign.write("PK\x03\x04", 4) == 4);
+    }
+    {
+        LifetimeIndex index;
+        QVERIFY(index.open(path));
+        QCOMPARE(index.size(), quint64(0));
+        QCOMPARE(QFileInfo(path).size(), validSize);
+    }
+}
+
+void CoreTests::journalReplaysAfterCompaction()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    GreetedState expected;
+    {
+        GreetedJournal journal(directory.path());
+        GreetedState state = journal.load();
+        QVERIFY(state.keys.size() == 0 && state.legacyLogins.isEmpty());
+
+        for (quint64 key = 1; key <= 100; ++key) {
+            journal.recordGreeted(key);
+            state.keys.insert(key);
+        }
+        journal.recordLegacyGreeted(QStringLiteral("oldname"));
+        state.legacyLogins.insert(QStringLiteral("oldname"));
+
+        journal.compact(state);
+
+        // Records after the compaction land in the next journal
+        for (quint64 key = 1; key <= 10; ++key) {
+            journal.recordUngreeted(key);
+            state.keys.remove(key);
+        }
+        journal.recordGreeted(500);
+        state.keys.insert(500);
+        journal.recordLegacyForgotten(QStringLiteral("oldname"));
+        state.legacyLogins.remove(QStringLiteral("oldname"));
+        expected = state;
+        // Destruction waits for the snapshot
+    }
+
+    {
+        GreetedJournal journal(directory.path());
+        const GreetedState state = journal.load();
+        QCOMPARE(state.keys.size(), expected.keys.size());
+        for (quint64 key = 1; key <= 100; ++key) {
+            QCOMPARE(state.keys.contains(key), expected.keys.contains(key));
+        }
+        QVERIFY(state.keys.contains(500));
+        QVERIFY(state.legacyLogins.isEmpty());
+
+        // A clear after replay wins over everything before it
+        journal.recordClear();
+        journal.recordGreeted(7);
+    }
+
+    GreetedJournal journal(directory.path());
+    const GreetedState state = journal.load();
+    QCOMPARE(state.keys.size(), size_t(1));
+    QVERIFY(state.keys.contains(7));
+}
+
+void CoreTests::nameIndexMatchesPrefixes()
+{
+    ChatterRegistry names;
+    ChatterNameIndex index;
+
+    // Display name and login per row, in arrival order
+    const char16_t *rows[][2] = {
+        {u"Alice", u"alice"},
+        {u"Alfred", u"alfred"},
+        {u"Bob", u"bob"},
+        {u"ÄrgerlichBot", u"aergerlich"},
+    };
+
+    // First batch goes in directly, the second is merged
+    for (int batchStart : {0, 2}) {
+        std::vector<ChatterNameIndex::Entry> batch;
+        for (int row = batchStart; row < batchStart + 2; ++row) {
+            for (const char16_t *name : rows[row]) {
+                batch.push_back({names.intern(QStringView(name)), static_cast<quint32>(row)});
+            }
+        }
+        index.insert(std::move(batch), names);
+    }
+    QCOMPARE(index.size(), size_t(8));
+
+    using Ordinals = std::vector<quint32>;
+    QCOMPARE(index.match(u"al", names), (Ordinals{1, 0}));
+    QCOMPARE(index.match(u"AL", names), (Ordinals{1, 0}));
+    // Display name and login both match; the row is listed once
+    QCOMPARE(index.match(u"alice", names), (Ordinals{0}));
+    QCOMPARE(index.match(u"b", names), (Ordinals{2}));
+    QCOMPARE(index.match(u"ä", names), (Ordinals{3}));
+    QCOMPARE(index.match(u"ae", names), (Ordinals{3}));
+    QCOMPARE(index.match(u"z", names), Ordinals{});
+    QCOMPARE(index.match(u"alicex", names), Ordinals{});
+    // An empty prefix matches every row, newest first
+    QCOMPARE(index.match(u"", names), (Ordinals{3, 2, 1, 0}));
+}
+
+void CoreTests::registryTrimsAndClears()
+{
+    ChatterRegistry names;
+    const ChatterRegistry::Handle alice = names.intern(u"Alice");
+    QCOMPARE(names.intern(u"Alice"), alice);
+    QCOMPARE(names.count(), size_t(1));
+
+    // A pair that would straddle the cut is dropped whole
+    QString longName(ChatterRegistry::MAX_NAME_LENGTH - 1, QLatin1Char('a'));
+    longName += QStringLiteral("\U0001F600tail");
+    QCOMPARE(names.view(names.intern(longName)).size(), qsizetype(ChatterRegistry::MAX_NAME_LENGTH - 1));
+    const QString plain(ChatterRegistry::MAX_NAME_LENGTH + 10, QLatin1Char('b'));
+    QCOMPARE(names.view(names.intern(plain)).size(), qsizetype(ChatterRegistry::MAX_NAME_LENGTH));
+
+    names.clear();
+    QCOMPARE(names.count(), size_t(0));
+    QCOMPARE(names.bytesUsed(), size_t(0));
+    QCOMPARE(names.view(names.intern(u"Bob")), QStringView(u"Bob"));
+    QCOMPARE(names.count(), size_t(1));
+}
+
+QTEST_GUILESS_MAIN(CoreTests)
+#include "core-tests.moc"